@@ -14,7 +14,7 @@
 /* UPDATE_SUMS makes nclusterbox update (rather than compute from scratch) the sums of the membership degrees on all elements after each addition/remotion step.  Define it. */
 #define UPDATE_SUMS
 
-/* REMEMBER makes nclusterbox called without option --forget (or -f) store every visited pattern either in a hash set (#define REMEMBER 1) or in a trie (#define REMEMBER 2) to avoid redundant computation if it is visited again.  Use #define REMEMBER 1. */
+/* REMEMBER makes nclusterbox called without option --forget (or -f) store every visited pattern either as a 128-bit fingerprint in a sharded hash table growing up to the memory set with option --vmem (#define REMEMBER 1) or in a trie (#define REMEMBER 2) to avoid redundant computation if it is visited again.  Use #define REMEMBER 1. */
 #define REMEMBER 1
 
 /* VERBOSE_PARSER turns on the output (on the standard output) of information when the input data are parsed. */
@@ -32,6 +32,9 @@
 /* NB_OF_PATTERNS turns on the output (on the standard output) of the numbers of patterns candidates for selection, and, then, of selected patterns. */
 #define NB_OF_PATTERNS
 
+/* NB_OF_ALLOCATIONS turns on the output (on the standard output) of the average numbers of memory allocations per initial pattern while modifying the patterns and per step while selecting them (in the thread selecting and in the workers updating the candidates).  It replaces the global operator new to count the allocations of every thread: do not define it when measuring times. */
+/* #define NB_OF_ALLOCATIONS */
+
 /* TIME turns on the output (on the standard output) of the run time of nclusterbox. */
 #define TIME
 
@@ -48,6 +51,8 @@
 /* - numeric precision for modifying patterns (#ifdef NUMERIC_PRECISION) */
 /* - tensor shifting time (#ifdef DETAILED_TIME) */
 /* - explanatory maximization time (#ifdef DETAILED_TIME) */
+/* - number of climbs pruned by the visited patterns filter and its estimated false-positive probability (#if REMEMBER == 1, with option --visited-budget) */
+/* - number of hopeless climbs, their average number of steps and that of the complete climbs (with option --abandon-climbs) */
 /* - number of patterns candidates for selection (#ifdef NB_OF_PATTERNS) */
 /* - numeric precision for selecting patterns (#ifdef NUMERIC_PRECISION) */
 /* - tensor reduction time (#ifdef DETAILED_TIME) */
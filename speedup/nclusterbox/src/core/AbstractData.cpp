@@ -30,28 +30,3 @@ void AbstractData::setTuple(const vector<unsigned int>::const_iterator idIt, con
 void AbstractData::sortTubes()
 {
 }
-
-void AbstractData::minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
-{
-  // *this is a crisp tube
-  // Never called
-}
-
-int AbstractData::minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
-{
-  // *this is a crisp tube
-  // Never called
-  return 0;
-}
-
-void AbstractData::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
-{
-  // *this is a crisp tube
-  // Never called
-}
-
-int AbstractData::decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
-{
-  // *this is a fuzzy tube and *dimensionIt is necessarily the increased dimension
-  return increaseSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
-}
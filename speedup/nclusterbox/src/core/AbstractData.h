@@ -15,6 +15,8 @@
 
 using namespace std;
 
+class FlatTrie;
+
 class AbstractData
 {
  public:
@@ -24,15 +26,7 @@ class AbstractData
   virtual void setTuple(const vector<unsigned int>::const_iterator idIt);
   virtual void setTuple(const vector<unsigned int>::const_iterator idIt, const int membership);
   virtual void sortTubes();
-
-  virtual void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const = 0;
-  virtual void minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
-  virtual int sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const = 0;
-  virtual int minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
-  virtual void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const = 0;
-  virtual void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
-  virtual int increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const = 0;
-  virtual int decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  virtual void flatten(FlatTrie& flatTrie) = 0;
 };
 
 #endif /*ABSTRACT_DATA_H_*/
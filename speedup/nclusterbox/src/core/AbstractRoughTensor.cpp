@@ -10,11 +10,13 @@
 
 #include <cmath>
 #include <iostream>
+#include <boost/dynamic_bitset.hpp>
 
 #include "DenseRoughTensor.h"
 
 #include "../utilities/NoOutputException.h"
 #include "TupleFileReader.h"
+#include "BinaryTensorFile.h"
 #include "FuzzyTupleFileReader.h"
 #include "SparseRoughTensor.h"
 #include "ConcurrentPatternPool.h"
@@ -125,46 +127,89 @@ void AbstractRoughTensor::output(const vector<vector<unsigned int>>& nSet, const
   outputStream << rssPrefix << rss / unit / unit << '\n';
 }
 
-AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(vector<FuzzyTuple>& fuzzyTuples, const double densityThreshold, const double shift)
+bool AbstractRoughTensor::isDenseStorageSmaller(const size_t nbOfTuples)
+{
+  // Dense storage (including the rough tensor) takes less space, assuming the sparse storage would only use sparse tubes
+  if (Trie::is01)
+    {
+      return (8 * sizeof(double) + 1) * getAreaFromIds2Labels() < 8 * (3 * sizeof(unsigned int*) + sizeof(unsigned int) * (ids2Labels.size() + 1) + sizeof(double)) * nbOfTuples;
+    }
+  return (sizeof(unsigned int) + sizeof(double)) * getAreaFromIds2Labels() < (3 * sizeof(unsigned int*) + sizeof(unsigned int) * (ids2Labels.size() + 2) + sizeof(double)) * nbOfTuples;
+}
+
+void AbstractRoughTensor::setSparseTubes(const double densityThreshold, const double shift)
 {
   if (Trie::is01)
     {
-      if ((8 * sizeof(double) + 1) * getAreaFromIds2Labels() < 8 * (3 * sizeof(unsigned int*) + sizeof(unsigned int) * (ids2Labels.size() + 1) + sizeof(double)) * fuzzyTuples.size())
-      	{
-	  // Dense storage (including the rough tensor) takes less space, assuming the sparse storage would only use sparse tubes
-	  return new DenseRoughTensor(fuzzyTuples, shift);
-      	}
-      setMetadata(fuzzyTuples, shift);
       SparseCrispTube::setDefaultMembershipAndSizeLimit(unit * -shift, densityThreshold * cardinalities.back() / sizeof(unsigned int) / 8);
       DenseCrispTube::setSize(cardinalities.back());
-      return new SparseRoughTensor(fuzzyTuples, shift);
+      return;
     }
-  if ((sizeof(unsigned int) + sizeof(double)) * getAreaFromIds2Labels() < (3 * sizeof(unsigned int*) + sizeof(unsigned int) * (ids2Labels.size() + 2) + sizeof(double)) * fuzzyTuples.size())
+  SparseFuzzyTube::setDefaultMembershipAndSizeLimit(unit * -shift, densityThreshold * cardinalities.back() / 2);
+  DenseFuzzyTube::setSize(cardinalities.back());
+}
+
+AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(FuzzyTupleArray& fuzzyTuples, const double densityThreshold, const double shift)
+{
+  if (isDenseStorageSmaller(fuzzyTuples.size()))
     {
-      // Dense storage (including the rough tensor) takes less space, assuming the sparse storage would only use sparse tubes
       return new DenseRoughTensor(fuzzyTuples, shift);
     }
   setMetadata(fuzzyTuples, shift);
-  SparseFuzzyTube::setDefaultMembershipAndSizeLimit(unit * -shift, densityThreshold * cardinalities.back() / 2);
-  DenseFuzzyTube::setSize(cardinalities.back());
+  setSparseTubes(densityThreshold, shift);
   return new SparseRoughTensor(fuzzyTuples, shift);
 }
 
-AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const bool isInput01, const bool isVerbose)
+AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(BinaryTensorFile* binaryTensor, const double densityThreshold, const double shift)
 {
-  vector<FuzzyTuple> fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, isVerbose);
+  if (isDenseStorageSmaller(binaryTensor->size()))
+    {
+      FuzzyTupleArray fuzzyTuples = binaryTensor->getFuzzyTuples();
+      delete binaryTensor;
+      return new DenseRoughTensor(fuzzyTuples, shift);
+    }
+  vector<vector<unsigned int>> fileIds2Ids = setMetadata(*binaryTensor, shift);
+  setSparseTubes(densityThreshold, shift);
+  return new SparseRoughTensor(binaryTensor, fileIds2Ids, shift);
+}
+
+AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const bool isInput01, const bool isStreamed, const bool isVerbose)
+{
+  FuzzyTupleArray fuzzyTuples;
+  BinaryTensorFile* binaryTensor = nullptr;
   double shift;
-  if (Trie::is01)
+  if (isStreamed)
     {
-      shift = fuzzyTuples.size();
+      binaryTensor = getBinaryTensor(tensorFileName, isInput01, isVerbose);
+      if (Trie::is01)
+	{
+	  shift = binaryTensor->size();
+	}
+      else
+	{
+	  shift = binaryTensor->getMembership(0);
+	  for (size_t tupleId = 1, nbOfTuples = binaryTensor->size(); tupleId != nbOfTuples; ++tupleId)
+	    {
+	      shift += binaryTensor->getMembership(tupleId);
+	    }
+	}
     }
   else
     {
-      vector<FuzzyTuple>::const_iterator fuzzyTupleIt = fuzzyTuples.begin();
-      shift = fuzzyTupleIt->getMembership();
-      for (const vector<FuzzyTuple>::const_iterator fuzzyTupleEnd = fuzzyTuples.end(); ++fuzzyTupleIt != fuzzyTupleEnd; )
+      fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, isVerbose);
+      if (Trie::is01)
+	{
+	  shift = fuzzyTuples.size();
+	}
+      else
 	{
-	  shift += fuzzyTupleIt->getMembership();
+	  const vector<double>& memberships = fuzzyTuples.getMemberships();
+	  vector<double>::const_iterator membershipIt = memberships.begin();
+	  shift = *membershipIt;
+	  for (const vector<double>::const_iterator membershipEnd = memberships.end(); ++membershipIt != membershipEnd; )
+	    {
+	      shift += *membershipIt;
+	    }
 	}
     }
   vector<vector<string>>::const_iterator ids2LabelsInDimensionIt = ids2Labels.begin();
@@ -176,12 +221,20 @@ AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(const char* tensorFile
       shift /= ids2LabelsInDimensionIt->size();
     }
   while (++ids2LabelsInDimensionIt != ids2LabelsInDimensionEnd);
+  if (binaryTensor)
+    {
+      return makeRoughTensor(binaryTensor, densityThreshold, shift);
+    }
   return makeRoughTensor(fuzzyTuples, densityThreshold, shift);
 }
 
-AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const double shift, const bool isInput01, const bool isVerbose)
+AbstractRoughTensor* AbstractRoughTensor::makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const double shift, const bool isInput01, const bool isStreamed, const bool isVerbose)
 {
-  vector<FuzzyTuple> fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, isVerbose);
+  if (isStreamed)
+    {
+      return makeRoughTensor(getBinaryTensor(tensorFileName, isInput01, isVerbose), densityThreshold, shift);
+    }
+  FuzzyTupleArray fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, isVerbose);
   return makeRoughTensor(fuzzyTuples, densityThreshold, shift);
 }
 
@@ -291,50 +344,19 @@ void AbstractRoughTensor::setUnitForProjectedTensor(const double rss, const vect
   setUnit(static_cast<double>(numeric_limits<int>::max()) / max(1., max(*max_element(elementNegativeMemberships.begin(), elementNegativeMemberships.end()), *max_element(elementPositiveMemberships.begin(), elementPositiveMemberships.end()))));
 }
 
-vector<FuzzyTuple> AbstractRoughTensor::getFuzzyTuples(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01, const bool isVerbose)
+void AbstractRoughTensor::beginLoading(const string& step, const bool isVerbose)
 {
-#if defined TIME || defined DETAILED_TIME
-  overallBeginning = steady_clock::now();
-#endif
-  if (isInput01)
-    {
-      if (isVerbose)
-	{
-	  cout << "Parsing Boolean tensor ... " << flush;
-	}
-      Trie::is01 = true;
-      TupleFileReader tupleFileReader(tensorFileName, inputDimensionSeparator, inputElementSeparator);
-      vector<FuzzyTuple> tuples = tupleFileReader.read();
-      ids2Labels = std::move(tupleFileReader.getIds2Labels());
-      if (isVerbose)
-	{
-	  cout << "\rParsing Boolean tensor: " << tuples.size() << '/' << getAreaFromIds2Labels() << " tuples with nonzero membership degrees.\n" << flush;
-	}
-#ifdef DETAILED_TIME
-      shiftingBeginning = steady_clock::now();
-#ifdef GNUPLOT
-      cout << duration_cast<duration<double>>(shiftingBeginning - overallBeginning).count();
-#else
-      cout << "Tensor parsing time: " << duration_cast<duration<double>>(shiftingBeginning - overallBeginning).count() << "s\n";
-#endif
-#endif
-      if (isVerbose)
-	{
-	  cout << "Shifting tensor ... " << flush;
-	}
-      return tuples;
-    }
   if (isVerbose)
     {
-      cout << "Parsing fuzzy tensor ... " << flush;
+      cout << step << " ... " << flush;
     }
-  FuzzyTupleFileReader fuzzyTupleFileReader(tensorFileName, inputDimensionSeparator, inputElementSeparator);
-  pair<vector<FuzzyTuple>, bool> fuzzyTuplesAndIs01 = fuzzyTupleFileReader.read();
-  Trie::is01 = fuzzyTuplesAndIs01.second;
-  ids2Labels = std::move(fuzzyTupleFileReader.getIds2Labels());
+}
+
+void AbstractRoughTensor::endLoading(const string& step, const size_t nbOfTuples, const bool isVerbose)
+{
   if (isVerbose)
     {
-      cout << "\rParsing fuzzy tensor: " << fuzzyTuplesAndIs01.first.size() << '/' << getAreaFromIds2Labels() << " tuples with nonzero membership degrees.\n" << flush;
+      cout << '\r' << step << ": " << nbOfTuples << '/' << getAreaFromIds2Labels() << " tuples with nonzero membership degrees.\n" << flush;
     }
 #ifdef DETAILED_TIME
   shiftingBeginning = steady_clock::now();
@@ -348,7 +370,65 @@ vector<FuzzyTuple> AbstractRoughTensor::getFuzzyTuples(const char* tensorFileNam
     {
       cout << "Shifting tensor ... " << flush;
     }
-  return fuzzyTuplesAndIs01.first;
+}
+
+FuzzyTupleArray AbstractRoughTensor::getFuzzyTuples(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01, const bool isVerbose)
+{
+#if defined TIME || defined DETAILED_TIME
+  overallBeginning = steady_clock::now();
+#endif
+  string step;
+  pair<FuzzyTupleArray, bool> fuzzyTuplesAndIs01;
+  if (BinaryTensorFile::isBinary(tensorFileName))
+    {
+      step = "Loading binary tensor";
+      beginLoading(step, isVerbose);
+      BinaryTensorFile binaryTensor(tensorFileName, isInput01);
+      fuzzyTuplesAndIs01 = {binaryTensor.getFuzzyTuples(), binaryTensor.isEveryMembership1()};
+      ids2Labels = std::move(binaryTensor.getIds2Labels());
+    }
+  else
+    {
+      if (isInput01)
+	{
+	  step = "Parsing Boolean tensor";
+	  beginLoading(step, isVerbose);
+	  TupleFileReader tupleFileReader(tensorFileName, inputDimensionSeparator, inputElementSeparator);
+	  fuzzyTuplesAndIs01 = {tupleFileReader.read(), true};
+	  ids2Labels = std::move(tupleFileReader.getIds2Labels());
+	}
+      else
+	{
+	  step = "Parsing fuzzy tensor";
+	  beginLoading(step, isVerbose);
+	  FuzzyTupleFileReader fuzzyTupleFileReader(tensorFileName, inputDimensionSeparator, inputElementSeparator);
+	  fuzzyTuplesAndIs01 = fuzzyTupleFileReader.read();
+	  ids2Labels = std::move(fuzzyTupleFileReader.getIds2Labels());
+	}
+    }
+  Trie::is01 = fuzzyTuplesAndIs01.second;
+  endLoading(step, fuzzyTuplesAndIs01.first.size(), isVerbose);
+  return std::move(fuzzyTuplesAndIs01.first);
+}
+
+BinaryTensorFile* AbstractRoughTensor::getBinaryTensor(const char* tensorFileName, const bool isInput01, const bool isVerbose)
+{
+#if defined TIME || defined DETAILED_TIME
+  overallBeginning = steady_clock::now();
+#endif
+  const string step = "Mapping binary tensor";
+  beginLoading(step, isVerbose);
+  BinaryTensorFile* binaryTensor = new BinaryTensorFile(tensorFileName, isInput01);
+  ids2Labels = std::move(binaryTensor->getIds2Labels());
+  Trie::is01 = binaryTensor->isEveryMembership1();
+  endLoading(step, binaryTensor->size(), isVerbose);
+  return binaryTensor;
+}
+
+void AbstractRoughTensor::convert(const char* tensorFileName, const char* binaryFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01)
+{
+  const FuzzyTupleArray fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, false);
+  BinaryTensorFile::write(binaryFileName, ids2Labels, fuzzyTuples, Trie::is01);
 }
 
 unsigned long long AbstractRoughTensor::getAreaFromIds2Labels()
@@ -395,7 +475,7 @@ void AbstractRoughTensor::orderDimensionsAndSetExternal2InternalDimensionOrderAn
   while (++dimensionId != n);
 }
 
-void AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId, const unsigned long long area, const double shift, double& unitDenominator, vector<string>& ids2LabelsInDimension, vector<FuzzyTuple>& fuzzyTuples)
+template<typename T> vector<unsigned int> AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId, const unsigned long long area, const double shift, double& unitDenominator, vector<string>& ids2LabelsInDimension, const T& fuzzyTuples)
 {
   // Sparse tensor
   const unsigned int nbOfElements = ids2LabelsInDimension.size();
@@ -413,14 +493,13 @@ void AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId
 	  }
 	while (++id != nbOfElements);
       }
-      const vector<FuzzyTuple>::iterator fuzzyTupleEnd = fuzzyTuples.end();
-      vector<FuzzyTuple>::iterator fuzzyTupleIt = fuzzyTuples.begin();
+      const size_t nbOfTuples = fuzzyTuples.size();
+      size_t tupleId = 0;
       do
 	{
-	  ++elementPositiveMemberships[fuzzyTupleIt->getElementId(dimensionId)].first;
+	  ++elementPositiveMemberships[fuzzyTuples.getElementId(tupleId, dimensionId)].first;
 	}
-      while (++fuzzyTupleIt != fuzzyTupleEnd);
-      fuzzyTupleIt = fuzzyTuples.begin();
+      while (++tupleId != nbOfTuples);
       sort(elementPositiveMemberships.begin(), elementPositiveMemberships.end(), [](const pair<double, unsigned int>& elementPositiveMembership1, const pair<unsigned int, unsigned int>& elementPositiveMembership2) {return elementPositiveMembership1.first < elementPositiveMembership2.first;});
       if (elementPositiveMemberships.back().first > unitDenominator)
 	{
@@ -443,14 +522,7 @@ void AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId
 	}
 	ids2LabelsInDimension = std::move(newIds2LabelsInDimension);
       }
-      // Remap the element of the fuzzyTuples accordingly
-      do
-	{
-	  unsigned int& elementId = fuzzyTupleIt->getElementId(dimensionId);
-	  elementId = mapping[elementId];
-	}
-      while (++fuzzyTupleIt != fuzzyTupleEnd);
-      return;
+      return mapping;
     }
   // !is01
   vector<pair<double, unsigned int>> elementPositiveMemberships;
@@ -463,13 +535,13 @@ void AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId
       }
     while (++id != nbOfElements);
   }
-  const vector<FuzzyTuple>::iterator fuzzyTupleEnd = fuzzyTuples.end();
-  vector<FuzzyTuple>::iterator fuzzyTupleIt = fuzzyTuples.begin();
+  const size_t nbOfTuples = fuzzyTuples.size();
+  size_t tupleId = 0;
   vector<double> elementNegativeMemberships(nbOfElements, shift * (area / nbOfElements)); // assumes every membership null and correct that in the loop below
   do
     {
-      const unsigned int elementId = fuzzyTupleIt->getElementId(dimensionId);
-      const double membership = fuzzyTupleIt->getMembership();
+      const unsigned int elementId = fuzzyTuples.getElementId(tupleId, dimensionId);
+      const double membership = fuzzyTuples.getMembership(tupleId) - shift;
       if (membership > 0)
 	{
 	  elementPositiveMemberships[elementId].first += membership;
@@ -480,8 +552,7 @@ void AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId
 	  elementNegativeMemberships[elementId] -= membership + shift;
 	}
     }
-  while (++fuzzyTupleIt != fuzzyTupleEnd);
-  fuzzyTupleIt = fuzzyTuples.begin();
+  while (++tupleId != nbOfTuples);
   const double maxNegativeMembership = *max_element(elementNegativeMemberships.begin(), elementNegativeMemberships.end());
   if (maxNegativeMembership > unitDenominator)
     {
@@ -510,32 +581,18 @@ void AbstractRoughTensor::setMetadataForDimension(const unsigned int dimensionId
     }
     ids2LabelsInDimension = std::move(newIds2LabelsInDimension);
   }
-  // Remap the element of the fuzzyTuples accordingly
-  do
-    {
-      unsigned int& elementId = fuzzyTupleIt->getElementId(dimensionId);
-      elementId = mapping[elementId];
-    }
-  while (++fuzzyTupleIt != fuzzyTupleEnd);
+  return mapping;
 }
 
-void AbstractRoughTensor::setMetadata(vector<FuzzyTuple>& fuzzyTuples, const double shift)
+template<typename T> vector<vector<unsigned int>> AbstractRoughTensor::setMetadataAndGetNewIds(const T& fuzzyTuples, const double shift)
 {
   // Sparse tensor
   const unsigned long long area = getAreaFromIds2Labels();
   orderDimensionsAndSetExternal2InternalDimensionOrderAndCardinalities();
   double unitDenominator;
-  const vector<FuzzyTuple>::iterator fuzzyTupleEnd = fuzzyTuples.end();
-  vector<FuzzyTuple>::iterator fuzzyTupleIt = fuzzyTuples.begin();
   if (Trie::is01)
     {
       nullModelRSS = (static_cast<double>(shift) * area - 2 * fuzzyTuples.size()) * shift + fuzzyTuples.size();
-      // Shift the membership of every tuple
-      do
-	{
-	  fuzzyTupleIt->shiftMembership(shift);
-	}
-      while (++fuzzyTupleIt != fuzzyTupleEnd);
       unitDenominator = unitDenominatorGivenNullModelRSS();
       const double maxElementNegativeMembership = shift * (area / cardinalities.front());
       if (maxElementNegativeMembership > unitDenominator)
@@ -546,39 +603,94 @@ void AbstractRoughTensor::setMetadata(vector<FuzzyTuple>& fuzzyTuples, const dou
   else
     {
       nullModelRSS = static_cast<double>(shift) * shift * (area - fuzzyTuples.size());
-      // Shift the membership of every tuple
+      const size_t nbOfTuples = fuzzyTuples.size();
+      size_t tupleId = 0;
       do
 	{
-	  fuzzyTupleIt->shiftMembership(shift);
-	  nullModelRSS += fuzzyTupleIt->getMembershipSquared();
+	  const double membership = fuzzyTuples.getMembership(tupleId) - shift;
+	  nullModelRSS += membership * membership;
 	}
-      while (++fuzzyTupleIt != fuzzyTupleEnd);
+      while (++tupleId != nbOfTuples);
       unitDenominator = unitDenominatorGivenNullModelRSS();
     }
-  fuzzyTupleIt = fuzzyTuples.begin();
+  vector<vector<unsigned int>> newIds;
+  newIds.reserve(ids2Labels.size());
   {
     vector<vector<string>>::iterator ids2LabelsInDimensionIt = ids2Labels.begin();
-    setMetadataForDimension(0, area, shift, unitDenominator, *ids2LabelsInDimensionIt, fuzzyTuples);
+    newIds.emplace_back(setMetadataForDimension(0, area, shift, unitDenominator, *ids2LabelsInDimensionIt, fuzzyTuples));
     const unsigned int n = ids2Labels.end() - ids2LabelsInDimensionIt;
     unsigned int dimensionId = 1;
     do
       {
-	setMetadataForDimension(dimensionId, area, shift, unitDenominator, *++ids2LabelsInDimensionIt, fuzzyTuples);
+	newIds.emplace_back(setMetadataForDimension(dimensionId, area, shift, unitDenominator, *++ids2LabelsInDimensionIt, fuzzyTuples));
       }
     while (++dimensionId != n);
   }
-  // Reorder fuzzy tuples, according to the new dimension order
-  do
-    {
-      fuzzyTupleIt->reorder(external2InternalDimensionOrder);
-      ConcurrentPatternPool::addFuzzyTuple(fuzzyTupleIt->getTuple(), fuzzyTupleIt->getMembership());
-    }
-  while (++fuzzyTupleIt != fuzzyTupleEnd);
   // Set unit
 #if defined NUMERIC_PRECISION && defined DETAILED_TIME && defined GNUPLOT
   cout << '\t' << unitDenominator / numeric_limits<int>::max();
 #endif
   setUnit(static_cast<double>(numeric_limits<int>::max()) / unitDenominator);
+  return newIds;
+}
+
+void AbstractRoughTensor::setMetadata(FuzzyTupleArray& fuzzyTuples, const double shift)
+{
+  const vector<vector<unsigned int>> newIds = setMetadataAndGetNewIds(fuzzyTuples, shift);
+  // Shift the memberships of the fuzzy tuples, remap their elements and reorder them according to the new dimension order
+  fuzzyTuples.shiftMemberships(shift);
+  {
+    const unsigned int n = newIds.size();
+    unsigned int dimensionId = 0;
+    do
+      {
+	fuzzyTuples.setNewIds(dimensionId, newIds[dimensionId]);
+      }
+    while (++dimensionId != n);
+  }
+  fuzzyTuples.reorder(external2InternalDimensionOrder);
+  const unsigned int n = ids2Labels.size();
+  const size_t nbOfTuples = fuzzyTuples.size();
+  size_t tupleId = 0;
+  do
+    {
+      const vector<unsigned int>::const_iterator tuple = fuzzyTuples.getTuple(tupleId);
+      ConcurrentPatternPool::addFuzzyTuple(tuple, tuple + n, fuzzyTuples.getMembership(tupleId));
+    }
+  while (++tupleId != nbOfTuples);
+}
+
+vector<vector<unsigned int>> AbstractRoughTensor::setMetadata(const BinaryTensorFile& binaryTensor, const double shift)
+{
+  vector<vector<unsigned int>> newIds = setMetadataAndGetNewIds(binaryTensor, shift);
+  // Index the new ids by internal dimension
+  const unsigned int n = newIds.size();
+  vector<vector<unsigned int>> fileIds2Ids(n);
+  {
+    unsigned int dimensionId = 0;
+    do
+      {
+	fileIds2Ids[external2InternalDimensionOrder[dimensionId]] = std::move(newIds[dimensionId]);
+      }
+    while (++dimensionId != n);
+  }
+  // Give ConcurrentPatternPool the shifted fuzzy tuples, with the new ids, in the new dimension order
+  vector<unsigned int> tuple(n);
+  const size_t nbOfTuples = binaryTensor.size();
+  size_t tupleId = 0;
+  do
+    {
+      unsigned int dimensionId = 0;
+      do
+	{
+	  const unsigned int internalDimensionId = external2InternalDimensionOrder[dimensionId];
+	  tuple[internalDimensionId] = fileIds2Ids[internalDimensionId][binaryTensor.getElementId(tupleId, dimensionId)];
+	}
+      while (++dimensionId != n);
+      ConcurrentPatternPool::addFuzzyTuple(tuple.begin(), tuple.end(), binaryTensor.getMembership(tupleId) - shift);
+    }
+  while (++tupleId != nbOfTuples);
+  return fileIds2Ids;
 }
 
 void AbstractRoughTensor::setMetadataForDimension(vector<pair<double, unsigned int>>& elementPositiveMembershipsInDimension, double& unitDenominator, vector<string>& ids2LabelsInDimension)
@@ -630,7 +742,7 @@ void AbstractRoughTensor::setMetadata(vector<vector<pair<double, unsigned int>>>
 void AbstractRoughTensor::projectMetadataForDimension(const unsigned int internalDimensionId, const bool isReturningOld2New, vector<string>& ids2LabelsInDimension, vector<unsigned int>& newIds2OldIdsInDimension)
 {
   unsigned int& cardinality = cardinalities[internalDimensionId];
-  dynamic_bitset<> elementsInDimension(cardinality);
+  boost::dynamic_bitset<> elementsInDimension(cardinality);
   const vector<vector<vector<unsigned int>>>::const_iterator end = candidateVariables.end();
   vector<vector<vector<unsigned int>>>::const_iterator patternIt = candidateVariables.begin();
   do
@@ -648,19 +760,19 @@ void AbstractRoughTensor::projectMetadataForDimension(const unsigned int interna
   cardinality = 0;
   if (isReturningOld2New)
     {
-      dynamic_bitset<>::size_type id = elementsInDimension.find_first();
+      boost::dynamic_bitset<>::size_type id = elementsInDimension.find_first();
       do
 	{
 	  ids2LabelsInDimension[id].swap(ids2LabelsInDimension[cardinality]);
 	  oldIds2NewIdsInDimension[id] = cardinality++;
 	  id = elementsInDimension.find_next(id);
 	}
-      while (id != dynamic_bitset<>::npos);
+      while (id != boost::dynamic_bitset<>::npos);
     }
   else
     {
       newIds2OldIdsInDimension.reserve(elementsInDimension.count());
-      dynamic_bitset<>::size_type id = elementsInDimension.find_first();
+      boost::dynamic_bitset<>::size_type id = elementsInDimension.find_first();
       do
 	{
 	  newIds2OldIdsInDimension.push_back(id);
@@ -668,7 +780,7 @@ void AbstractRoughTensor::projectMetadataForDimension(const unsigned int interna
 	  oldIds2NewIdsInDimension[id] = cardinality++;
 	  id = elementsInDimension.find_next(id);
 	}
-      while (id != dynamic_bitset<>::npos);
+      while (id != boost::dynamic_bitset<>::npos);
     }
   const vector<vector<vector<unsigned int>>>::iterator candidateVariableEnd = candidateVariables.end();
   vector<vector<vector<unsigned int>>>::iterator candidateVariableIt = candidateVariables.begin();
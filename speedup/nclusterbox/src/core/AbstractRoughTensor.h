@@ -15,7 +15,7 @@
 #include <fstream>
 
 #include "../../Parameters.h"
-#include "FuzzyTuple.h"
+#include "BinaryTensorFile.h"
 #include "Trie.h"
 #include "TrieWithPrediction.h"
 
@@ -41,9 +41,10 @@ class AbstractRoughTensor
   void output(const vector<vector<unsigned int>>& nSet, const float density) const;
   void output(const vector<vector<unsigned int>>& nSet, const float density, const double rss) const;
 
-  static AbstractRoughTensor* makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const bool isInput01, const bool isVerbose);
-  static AbstractRoughTensor* makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const double shift, const bool isInput01, const bool isVerbose);
+  static AbstractRoughTensor* makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const bool isInput01, const bool isStreamed, const bool isVerbose);
+  static AbstractRoughTensor* makeRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const double densityThreshold, const double shift, const bool isInput01, const bool isStreamed, const bool isVerbose); /* if isStreamed, the tensor must be binary and a sparse storage reads it from the file rather than from a copy of its tuples */
 
+  static void convert(const char* tensorFileName, const char* binaryFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01);
   static void setOutput(const char* outputFileName, const char* outputDimensionSeparator, const char* outputElementSeparator, const char* hierarchyPrefix, const char* hierarchySeparator, const char* sizePrefix, const char* sizeSeparator, const char* areaPrefix, const char* rssPrefix, const bool isPrintLambda, const bool isSizePrinted, const bool isAreaPrinted, const bool isNoSelection);
   static int getUnit();
   static bool isDirectOutput();
@@ -71,9 +72,10 @@ class AbstractRoughTensor
   static double unitDenominatorGivenNullModelRSS();
   static void setUnit(const int unit);
   static void setUnitForProjectedTensor(const double rss, const vector<double>& elementNegativeMemberships, const vector<double>& elementPositiveMemberships);
-  static vector<FuzzyTuple> getFuzzyTuples(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01, const bool isVerbose);
+  static FuzzyTupleArray getFuzzyTuples(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01, const bool isVerbose);
   static void orderDimensionsAndSetExternal2InternalDimensionOrderAndCardinalities();
-  static void setMetadata(vector<FuzzyTuple>& fuzzyTuples, const double shift);
+  static void setMetadata(FuzzyTupleArray& fuzzyTuples, const double shift);
+  static vector<vector<unsigned int>> setMetadata(const BinaryTensorFile& binaryTensor, const double shift); /* returns, for every internal dimension, the new id of every element in the file */
   static void setMetadata(vector<vector<pair<double, unsigned int>>>& elementPositiveMemberships, const double maxNegativeMembership); /* the inner vectors of elementPositiveMemberships are reordered by increasing element membership, hence a mapping from new ids (the index) and old ids (the second component of the pairs) */
   static vector<vector<unsigned int>> projectMetadata(const bool isReturningOld2New);
 
@@ -99,10 +101,17 @@ class AbstractRoughTensor
 #endif
 #endif
 
-  static AbstractRoughTensor* makeRoughTensor(vector<FuzzyTuple>& fuzzyTuples, const double densityThreshold, const double shift);
+  static AbstractRoughTensor* makeRoughTensor(FuzzyTupleArray& fuzzyTuples, const double densityThreshold, const double shift);
+  static AbstractRoughTensor* makeRoughTensor(BinaryTensorFile* binaryTensor, const double densityThreshold, const double shift);
+  static void beginLoading(const string& step, const bool isVerbose);
+  static void endLoading(const string& step, const size_t nbOfTuples, const bool isVerbose);
+  static BinaryTensorFile* getBinaryTensor(const char* tensorFileName, const bool isInput01, const bool isVerbose); // tensorFileName must be a binary tensor
+  static bool isDenseStorageSmaller(const size_t nbOfTuples);
+  static void setSparseTubes(const double densityThreshold, const double shift);
   static unsigned long long getAreaFromIds2Labels();
   static void printDimension(const vector<unsigned int>& dimension, const vector<string>& ids2LabelsInDimension, ostream& out);
-  static void setMetadataForDimension(const unsigned int dimensionId, const unsigned long long area, const double shift, double& unitDenominator, vector<string>& ids2LabelsInDimension, vector<FuzzyTuple>& fuzzyTuples);
+  template<typename T> static vector<vector<unsigned int>> setMetadataAndGetNewIds(const T& fuzzyTuples, const double shift); /* T is FuzzyTupleArray or BinaryTensorFile, whose memberships are not shifted yet */
+  template<typename T> static vector<unsigned int> setMetadataForDimension(const unsigned int dimensionId, const unsigned long long area, const double shift, double& unitDenominator, vector<string>& ids2LabelsInDimension, const T& fuzzyTuples);
   static void setMetadataForDimension(vector<pair<double, unsigned int>>& elementPositiveMembershipsInDimension, double& unitDenominator, vector<string>& ids2LabelsInDimension);
   static void projectMetadataForDimension(const unsigned int internalDimensionId, const bool isReturningOld2New, vector<string>& ids2LabelsInDimension, vector<unsigned int>& newIds2OldIdsInDimension);
 };
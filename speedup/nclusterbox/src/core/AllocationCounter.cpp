@@ -0,0 +1,59 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "AllocationCounter.h"
+
+#ifdef NB_OF_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+static thread_local unsigned long long nbOfAllocationsInThread = 0;
+
+unsigned long long AllocationCounter::getNbOfAllocationsInThread()
+{
+  return nbOfAllocationsInThread;
+}
+
+void* operator new(const size_t size)
+{
+  ++nbOfAllocationsInThread;
+  void* const memory = malloc(size ? size : 1);
+  if (!memory)
+    {
+      throw std::bad_alloc();
+    }
+  return memory;
+}
+
+void* operator new[](const size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* const memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void* const memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void* const memory, const size_t) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void* const memory, const size_t) noexcept
+{
+  free(memory);
+}
+#endif
@@ -1,4 +1,4 @@
-// Copyright 2018,2019 Loïc Cerf (lcerf@dcc.ufmg.br)
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
 
 // This file is part of nclusterbox.
 
@@ -8,8 +8,18 @@
 
 // You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
 
-#include "AbstractDataWithPrediction.h"
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
 
-AbstractDataWithPrediction::~AbstractDataWithPrediction()
+#include "../../Parameters.h"
+
+#ifdef NB_OF_ALLOCATIONS
+/* Counts, in every thread, the calls of the global operator new, which AllocationCounter.cpp replaces */
+class AllocationCounter
 {
-}
+ public:
+  static unsigned long long getNbOfAllocationsInThread();
+};
+#endif
+
+#endif /*ALLOCATION_COUNTER_H_*/
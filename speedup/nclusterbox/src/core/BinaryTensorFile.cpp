@@ -0,0 +1,245 @@
+// Copyright 2018-2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "BinaryTensorFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <boost/lexical_cast.hpp>
+
+#include "../utilities/UsageException.h"
+#include "../utilities/NoInputException.h"
+#include "../utilities/NoOutputException.h"
+
+const char BinaryTensorFile::magicNumber[8] = {'n', 'c', 'l', 'b', 'o', 'x', '\0', '\1'};
+const unsigned int BinaryTensorFile::version = 1;
+
+bool BinaryTensorFile::isBinary(const char* tensorFileName)
+{
+  if (string(tensorFileName) == "-")
+    {
+      return false;
+    }
+  char start[sizeof(magicNumber)];
+  ifstream tensorFile(tensorFileName, ios::binary);
+  return tensorFile.read(start, sizeof(magicNumber)) && memcmp(start, magicNumber, sizeof(magicNumber)) == 0;
+}
+
+BinaryTensorFile::BinaryTensorFile(const char* tensorFileName, const bool isInput01): mapping(nullptr), mappingSize(0), ids2Labels(), n(0), nbOfTuples(0), ids(nullptr), memberships(nullptr)
+{
+  const int fileDescriptor = open(tensorFileName, O_RDONLY);
+  if (fileDescriptor == -1)
+    {
+      throw NoInputException(tensorFileName);
+    }
+  struct stat fileStatus;
+  if (fstat(fileDescriptor, &fileStatus) == -1)
+    {
+      close(fileDescriptor);
+      throw NoInputException(tensorFileName);
+    }
+  mappingSize = fileStatus.st_size;
+  mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED)
+    {
+      throw NoInputException(tensorFileName);
+    }
+  madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+  const char* const fileBegin = static_cast<const char*>(mapping);
+  const char* const fileEnd = fileBegin + mappingSize;
+  const char* position = fileBegin + sizeof(magicNumber);
+  const auto readUnsignedInt = [this, &position, fileEnd, tensorFileName]()
+  {
+    if (fileEnd - position < static_cast<ptrdiff_t>(sizeof(unsigned int)))
+      {
+	munmap(mapping, mappingSize);
+	throw UsageException((string(tensorFileName) + " is a truncated binary tensor!").c_str());
+      }
+    unsigned int value;
+    memcpy(&value, position, sizeof(unsigned int));
+    position += sizeof(unsigned int);
+    return value;
+  };
+  // Header
+  const unsigned int fileVersion = readUnsignedInt();
+  if (fileVersion != version)
+    {
+      munmap(mapping, mappingSize);
+      throw UsageException((string(tensorFileName) + " is a binary tensor in version " + boost::lexical_cast<string>(fileVersion) + ", but only version " + boost::lexical_cast<string>(version) + " is supported!").c_str());
+    }
+  n = readUnsignedInt();
+  const bool isFileWithMemberships = readUnsignedInt();
+  nbOfTuples = readUnsignedInt();
+  nbOfTuples |= static_cast<size_t>(readUnsignedInt()) << 32;
+  if (n < 2 || !nbOfTuples)
+    {
+      munmap(mapping, mappingSize);
+      throw UsageException(("No fuzzy tuple in " + string(tensorFileName) + '!').c_str());
+    }
+  if (n > static_cast<size_t>(fileEnd - position) / sizeof(unsigned int))
+    {
+      // every dimension takes at least its cardinality
+      munmap(mapping, mappingSize);
+      throw UsageException((string(tensorFileName) + " is a truncated binary tensor!").c_str());
+    }
+  // Labels
+  ids2Labels.resize(n);
+  for (vector<string>& ids2LabelsInDimension : ids2Labels)
+    {
+      unsigned int cardinality = readUnsignedInt();
+      ids2LabelsInDimension.reserve(cardinality);
+      for (; cardinality; --cardinality)
+	{
+	  const unsigned int labelSize = readUnsignedInt();
+	  if (static_cast<size_t>(fileEnd - position) < labelSize)
+	    {
+	      munmap(mapping, mappingSize);
+	      throw UsageException((string(tensorFileName) + " is a truncated binary tensor!").c_str());
+	    }
+	  ids2LabelsInDimension.emplace_back(position, labelSize);
+	  position += labelSize;
+	}
+    }
+  // Tuples and memberships
+  // The sizes are compared through divisions, since a corrupted number of tuples would make the products overflow
+  const size_t tupleOffset = (position - fileBegin + 7) / 8 * 8;
+  if (tupleOffset > mappingSize || nbOfTuples > (mappingSize - tupleOffset) / (n * sizeof(unsigned int)))
+    {
+      munmap(mapping, mappingSize);
+      throw UsageException((string(tensorFileName) + " is a truncated binary tensor!").c_str());
+    }
+  const size_t membershipOffset = (tupleOffset + nbOfTuples * n * sizeof(unsigned int) + 7) / 8 * 8;
+  if (isFileWithMemberships && (membershipOffset > mappingSize || nbOfTuples > (mappingSize - membershipOffset) / sizeof(double)))
+    {
+      munmap(mapping, mappingSize);
+      throw UsageException((string(tensorFileName) + " is a truncated binary tensor!").c_str());
+    }
+  ids = reinterpret_cast<const unsigned int*>(fileBegin + tupleOffset);
+  // Every id must be that of an element with a label
+  const unsigned int* const idEnd = ids + nbOfTuples * n;
+  for (const unsigned int* idIt = ids; idIt != idEnd; )
+    {
+      for (const vector<string>& ids2LabelsInDimension : ids2Labels)
+	{
+	  if (*idIt++ >= ids2LabelsInDimension.size())
+	    {
+	      munmap(mapping, mappingSize);
+	      throw UsageException((string(tensorFileName) + " is a corrupted binary tensor: an id exceeds the cardinality of its dimension!").c_str());
+	    }
+	}
+    }
+  if (isFileWithMemberships && !isInput01)
+    {
+      memberships = reinterpret_cast<const double*>(fileBegin + membershipOffset);
+    }
+}
+
+BinaryTensorFile::~BinaryTensorFile()
+{
+  munmap(mapping, mappingSize);
+}
+
+vector<vector<string>>& BinaryTensorFile::getIds2Labels()
+{
+  return ids2Labels;
+}
+
+bool BinaryTensorFile::isEveryMembership1() const
+{
+  return !memberships;
+}
+
+size_t BinaryTensorFile::size() const
+{
+  return nbOfTuples;
+}
+
+unsigned int BinaryTensorFile::getElementId(const size_t tupleId, const unsigned int dimensionId) const
+{
+  return ids[tupleId * n + dimensionId];
+}
+
+double BinaryTensorFile::getMembership(const size_t tupleId) const
+{
+  if (memberships)
+    {
+      return memberships[tupleId];
+    }
+  return 1;
+}
+
+FuzzyTupleArray BinaryTensorFile::getFuzzyTuples() const
+{
+  FuzzyTupleArray fuzzyTuples(n);
+  fuzzyTuples.assign(ids, nbOfTuples, memberships);
+  return fuzzyTuples;
+}
+
+void BinaryTensorFile::write(const char* binaryFileName, const vector<vector<string>>& ids2Labels, const FuzzyTupleArray& fuzzyTuples, const bool is01)
+{
+  ofstream binaryFile(binaryFileName, ios::binary);
+  if (!binaryFile)
+    {
+      throw NoOutputException(binaryFileName);
+    }
+  const auto writeUnsignedInt = [&binaryFile](const unsigned int value)
+  {
+    binaryFile.write(reinterpret_cast<const char*>(&value), sizeof(unsigned int));
+  };
+  // Header
+  binaryFile.write(magicNumber, sizeof(magicNumber));
+  writeUnsignedInt(version);
+  writeUnsignedInt(ids2Labels.size());
+  writeUnsignedInt(!is01);
+  const unsigned long long nbOfTuples = fuzzyTuples.size();
+  writeUnsignedInt(nbOfTuples);
+  writeUnsignedInt(nbOfTuples >> 32);
+  // Labels
+  for (const vector<string>& ids2LabelsInDimension : ids2Labels)
+    {
+      writeUnsignedInt(ids2LabelsInDimension.size());
+      for (const string& label : ids2LabelsInDimension)
+	{
+	  writeUnsignedInt(label.size());
+	  binaryFile.write(label.data(), label.size());
+	}
+    }
+  const char padding[8] = {};
+  binaryFile.write(padding, (8 - static_cast<streamoff>(binaryFile.tellp()) % 8) % 8);
+  // Tuples and memberships
+  const vector<unsigned int>& ids = fuzzyTuples.getIds();
+  binaryFile.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(unsigned int));
+  binaryFile.write(padding, (8 - static_cast<streamoff>(binaryFile.tellp()) % 8) % 8);
+  if (!is01)
+    {
+      const vector<double>& memberships = fuzzyTuples.getMemberships();
+      if (memberships.empty())
+	{
+	  for (size_t tupleId = 0, nbOfTuples = fuzzyTuples.size(); tupleId != nbOfTuples; ++tupleId)
+	    {
+	      const double membership = fuzzyTuples.getMembership(tupleId);
+	      binaryFile.write(reinterpret_cast<const char*>(&membership), sizeof(double));
+	    }
+	}
+      else
+	{
+	  binaryFile.write(reinterpret_cast<const char*>(memberships.data()), memberships.size() * sizeof(double));
+	}
+    }
+  if (!binaryFile)
+    {
+      throw NoOutputException(binaryFileName);
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright 2018-2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef BINARY_TENSOR_FILE_H_
+#define BINARY_TENSOR_FILE_H_
+
+#include <string>
+
+#include "FuzzyTupleArray.h"
+
+/* Layout, in the native byte order, of a binary tensor file:
+   - the 8-byte magic number "nclbox\0\1";
+   - the version, the number n of dimensions and the membership encoding (0 if every membership is 1, 1 for doubles) as 32-bit unsigned integers;
+   - the number of tuples as a 64-bit unsigned integer;
+   - for each of the n dimensions, its cardinality as a 32-bit unsigned integer, followed by that many labels, every label being its size as a 32-bit unsigned integer followed by its characters;
+   - zero-padding to a multiple of 8 bytes;
+   - the tuples, unique and in decreasing lexicographic order, each being n 32-bit unsigned ids;
+   - zero-padding to a multiple of 8 bytes;
+   - unless every membership is 1, the memberships of the tuples as doubles. */
+
+class BinaryTensorFile
+{
+ public:
+  BinaryTensorFile(const BinaryTensorFile& otherBinaryTensorFile) = delete;
+  BinaryTensorFile(const char* tensorFileName, const bool isInput01); /* every membership is considered 1 if isInput01 */
+  ~BinaryTensorFile();
+
+  BinaryTensorFile& operator=(const BinaryTensorFile& otherBinaryTensorFile) = delete;
+
+  vector<vector<string>>& getIds2Labels();
+  bool isEveryMembership1() const;
+  size_t size() const;
+  unsigned int getElementId(const size_t tupleId, const unsigned int dimensionId) const;
+  double getMembership(const size_t tupleId) const;
+  FuzzyTupleArray getFuzzyTuples() const; /* copies the tuples in the file, which are unique and in decreasing lexicographic order */
+
+  static bool isBinary(const char* tensorFileName); /* returns whether the file starts with the magic number */
+  static void write(const char* binaryFileName, const vector<vector<string>>& ids2Labels, const FuzzyTupleArray& fuzzyTuples, const bool is01);
+
+ private:
+  void* mapping;
+  size_t mappingSize;
+  vector<vector<string>> ids2Labels;
+  unsigned int n;
+  size_t nbOfTuples;
+  const unsigned int* ids;
+  const double* memberships;	/* nullptr if every membership is 1 */
+
+  static const char magicNumber[8];
+  static const unsigned int version;
+};
+
+#endif /*BINARY_TENSOR_FILE_H_*/
@@ -0,0 +1,243 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "CandidateIndex.h"
+
+#include <limits>
+#include <algorithm>
+
+const unsigned int CandidateIndex::noPosition = numeric_limits<unsigned int>::max();
+
+CandidateIndex::CandidateIndex(): candidateBegin(), postings(), ids(), positions(), stamps(), stamp(0), overlapping(), nbOfLeaves(0), winners()
+{
+}
+
+void CandidateIndex::init(const vector<CandidateVariable>::const_iterator candidateBeginParam, const vector<CandidateVariable>::const_iterator candidateEnd)
+{
+  candidateBegin = candidateBeginParam;
+  const unsigned int nbOfCandidates = candidateEnd - candidateBegin;
+  ids.resize(nbOfCandidates);
+  positions.resize(nbOfCandidates);
+  for (unsigned int id = 0; id != nbOfCandidates; ++id)
+    {
+      ids[id] = id;
+      positions[id] = id;
+    }
+  stamps.assign(nbOfCandidates, 0);
+  stamp = 0;
+  // Postings
+  postings.clear();
+  if (nbOfCandidates)
+    {
+      postings.resize(candidateBegin->getNSet().size());
+    }
+  unsigned int id = 0;
+  for (vector<CandidateVariable>::const_iterator candidateIt = candidateBegin; candidateIt != candidateEnd; ++candidateIt)
+    {
+      vector<vector<vector<unsigned int>>>::iterator postingsInDimensionIt = postings.begin();
+      for (const vector<unsigned int>& dimension : candidateIt->getNSet())
+	{
+	  if (postingsInDimensionIt->size() <= dimension.back())
+	    {
+	      postingsInDimensionIt->resize(dimension.back() + 1);
+	    }
+	  for (const unsigned int elementId : dimension)
+	    {
+	      (*postingsInDimensionIt)[elementId].push_back(id);
+	    }
+	  ++postingsInDimensionIt;
+	}
+      ++id;
+    }
+  // Tournament tree
+  nbOfLeaves = 1;
+  while (nbOfLeaves < nbOfCandidates)
+    {
+      nbOfLeaves *= 2;
+    }
+  winners.assign(2 * nbOfLeaves, noPosition);
+  rebuild();
+}
+
+void CandidateIndex::clear()
+{
+  postings.clear();
+  postings.shrink_to_fit();
+  ids.clear();
+  ids.shrink_to_fit();
+  positions.clear();
+  positions.shrink_to_fit();
+  stamps.clear();
+  stamps.shrink_to_fit();
+  overlapping.clear();
+  overlapping.shrink_to_fit();
+  winners.clear();
+  winners.shrink_to_fit();
+}
+
+void CandidateIndex::swap(const unsigned int position1, const unsigned int position2)
+{
+  std::swap(ids[position1], ids[position2]);
+  positions[ids[position1]] = position1;
+  positions[ids[position2]] = position2;
+  update(position1);
+  update(position2);
+}
+
+void CandidateIndex::erase(const unsigned int position, const unsigned int lastPosition)
+{
+  positions[ids[position]] = noPosition;
+  if (position != lastPosition)
+    {
+      ids[position] = ids[lastPosition];
+      positions[ids[position]] = position;
+      update(position);
+    }
+  ids[lastPosition] = noPosition;
+  winners[nbOfLeaves + lastPosition] = noPosition;
+  updateAncestors((nbOfLeaves + lastPosition) / 2);
+}
+
+void CandidateIndex::update(const unsigned int position)
+{
+  // The leaf of a position holds the position itself, unless erased
+  updateAncestors((nbOfLeaves + position) / 2);
+}
+
+void CandidateIndex::rebuild()
+{
+  // Leaves
+  const unsigned int nbOfPositions = ids.size();
+  for (unsigned int position = 0; position != nbOfPositions; ++position)
+    {
+      if (ids[position] == noPosition)
+	{
+	  winners[nbOfLeaves + position] = noPosition;
+	}
+      else
+	{
+	  winners[nbOfLeaves + position] = position;
+	}
+    }
+  // Internal nodes, from the deepest ones
+  for (unsigned int nodeId = nbOfLeaves - 1; nodeId; --nodeId)
+    {
+      winners[nodeId] = winner(winners[2 * nodeId], winners[2 * nodeId + 1]);
+    }
+}
+
+const vector<unsigned int>& CandidateIndex::overlappingPositions(const vector<vector<unsigned int>>& nSet, const unsigned int begin, const unsigned int end)
+{
+  // Dimension of nSet whose elements are in the fewest candidates
+  vector<vector<vector<unsigned int>>>::const_iterator rarestPostingsInDimensionIt = postings.begin();
+  vector<vector<unsigned int>>::const_iterator rarestDimensionIt = nSet.begin();
+  unsigned long long minNbOfPostings = numeric_limits<unsigned long long>::max();
+  vector<vector<vector<unsigned int>>>::const_iterator postingsInDimensionIt = postings.begin();
+  for (vector<vector<unsigned int>>::const_iterator dimensionIt = nSet.begin(); dimensionIt != nSet.end(); ++dimensionIt)
+    {
+      unsigned long long nbOfPostings = 0;
+      for (const unsigned int elementId : *dimensionIt)
+	{
+	  if (elementId < postingsInDimensionIt->size())
+	    {
+	      nbOfPostings += (*postingsInDimensionIt)[elementId].size();
+	    }
+	}
+      if (nbOfPostings < minNbOfPostings)
+	{
+	  minNbOfPostings = nbOfPostings;
+	  rarestPostingsInDimensionIt = postingsInDimensionIt;
+	  rarestDimensionIt = dimensionIt;
+	}
+      ++postingsInDimensionIt;
+    }
+  // Positions in [begin, end) of the candidates in these postings, each one once
+  if (!++stamp)
+    {
+      // Overflow: forget the previous stamps
+      stamps.assign(stamps.size(), 0);
+      stamp = 1;
+    }
+  overlapping.clear();
+  for (const unsigned int elementId : *rarestDimensionIt)
+    {
+      if (elementId < rarestPostingsInDimensionIt->size())
+	{
+	  for (const unsigned int id : (*rarestPostingsInDimensionIt)[elementId])
+	    {
+	      if (stamps[id] != stamp)
+		{
+		  stamps[id] = stamp;
+		  const unsigned int position = positions[id];
+		  if (position >= begin && position < end)
+		    {
+		      overlapping.push_back(position);
+		    }
+		}
+	    }
+	}
+    }
+  sort(overlapping.begin(), overlapping.end());
+  return overlapping;
+}
+
+unsigned int CandidateIndex::bestPosition(unsigned int begin, unsigned int end) const
+{
+  unsigned int best = noPosition;
+  for (begin += nbOfLeaves, end += nbOfLeaves; begin < end; begin /= 2, end /= 2)
+    {
+      if (begin & 1)
+	{
+	  best = winner(best, winners[begin++]);
+	}
+      if (end & 1)
+	{
+	  best = winner(best, winners[--end]);
+	}
+    }
+  return best;
+}
+
+unsigned int CandidateIndex::getId(const unsigned int position) const
+{
+  return ids[position];
+}
+
+unsigned int CandidateIndex::getPosition(const unsigned int id) const
+{
+  return positions[id];
+}
+
+unsigned int CandidateIndex::winner(const unsigned int leftPosition, const unsigned int rightPosition) const
+{
+  if (leftPosition == noPosition)
+    {
+      return rightPosition;
+    }
+  if (rightPosition == noPosition)
+    {
+      return leftPosition;
+    }
+  const long long leftRSSVariation = candidateBegin[leftPosition].getRSSVariation();
+  const long long rightRSSVariation = candidateBegin[rightPosition].getRSSVariation();
+  if (leftRSSVariation < rightRSSVariation || (leftRSSVariation == rightRSSVariation && leftPosition < rightPosition))
+    {
+      return leftPosition;
+    }
+  return rightPosition;
+}
+
+void CandidateIndex::updateAncestors(unsigned int nodeId)
+{
+  for (; nodeId; nodeId /= 2)
+    {
+      winners[nodeId] = winner(winners[2 * nodeId], winners[2 * nodeId + 1]);
+    }
+}
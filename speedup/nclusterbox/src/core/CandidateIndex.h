@@ -0,0 +1,52 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CANDIDATE_INDEX_H_
+#define CANDIDATE_INDEX_H_
+
+#include "CandidateVariable.h"
+
+/* Index of the candidates for selection, in a vector whose elements are swapped and erased (by moving the last one) but never reallocated: an inverted index from every (dimension, element) to the candidates containing it, and a tournament tree electing, in any range of positions, the candidate with the smallest RSS variation (the first one in case of equality) */
+class CandidateIndex
+{
+ public:
+  static const unsigned int noPosition;
+
+  CandidateIndex();
+
+  void init(const vector<CandidateVariable>::const_iterator candidateBegin, const vector<CandidateVariable>::const_iterator candidateEnd);
+  void clear();
+
+  void swap(const unsigned int position1, const unsigned int position2); /* after the candidates at these positions were swapped */
+  void erase(const unsigned int position, const unsigned int lastPosition); /* after the candidate at position was overwritten by that at lastPosition */
+  void update(const unsigned int position); /* after the RSS variation of the candidate at position changed, in O(log(nb of candidates)) */
+  void rebuild(); /* after the RSS variations of many candidates changed, in O(nb of candidates) */
+
+  const vector<unsigned int>& overlappingPositions(const vector<vector<unsigned int>>& nSet, const unsigned int begin, const unsigned int end); /* increasing positions in [begin, end) of the candidates sharing with nSet an element of the dimension where that is the rarest: a superset of those overlapping nSet; the returned buffer is reused by the next call */
+  unsigned int bestPosition(const unsigned int begin, const unsigned int end) const; /* noPosition if begin == end */
+  unsigned int getId(const unsigned int position) const; /* the initial position of the candidate */
+  unsigned int getPosition(const unsigned int id) const; /* noPosition if erased */
+
+ private:
+  vector<CandidateVariable>::const_iterator candidateBegin;
+  vector<vector<vector<unsigned int>>> postings; /* postings[dimensionId][elementId] lists the ids of the candidates containing the element */
+  vector<unsigned int> ids; /* ids[position], initially position */
+  vector<unsigned int> positions; /* positions[id], noPosition if erased */
+  vector<unsigned int> stamps; /* stamps[id] == stamp if the id was already met in the current call of overlappingPositions */
+  unsigned int stamp;
+  vector<unsigned int> overlapping;
+  unsigned int nbOfLeaves;
+  vector<unsigned int> winners; /* winners[1] is the root, the leaves start at nbOfLeaves */
+
+  unsigned int winner(const unsigned int leftPosition, const unsigned int rightPosition) const;
+  void updateAncestors(unsigned int nodeId);
+};
+
+#endif /*CANDIDATE_INDEX_H_*/
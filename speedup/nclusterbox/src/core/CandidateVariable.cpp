@@ -88,37 +88,23 @@ bool CandidateVariable::overlaps(const vector<vector<unsigned int>>::const_itera
   return true;
 }
 
-vector<vector<unsigned int>> CandidateVariable::inter(const vector<vector<unsigned int>>::const_iterator otherDimensionBegin) const
+bool CandidateVariable::inter(const vector<vector<unsigned int>>::const_iterator otherDimensionBegin, vector<vector<unsigned int>>& intersection) const
 {
+  intersection.resize(nSet.size());
   vector<vector<unsigned int>>::const_iterator otherDimensionIt = otherDimensionBegin;
-  vector<vector<unsigned int>>::const_iterator dimensionIt = nSet.begin();
-  vector<vector<unsigned int>> intersection;
-  intersection.reserve(nSet.size());
-  intersection.emplace_back();
-  set_intersection(dimensionIt->begin(), dimensionIt->end(), otherDimensionIt->begin(), otherDimensionIt->end(), back_inserter(intersection.back()));
-  if (intersection.back().empty())
-    {
-      return {};
-    }
-  intersection.emplace_back();
-  ++dimensionIt;
-  ++otherDimensionIt;
-  set_intersection(dimensionIt->begin(), dimensionIt->end(), otherDimensionIt->begin(), otherDimensionIt->end(), back_inserter(intersection.back()));
-  if (intersection.back().empty())
+  vector<vector<unsigned int>>::iterator intersectionDimensionIt = intersection.begin();
+  for (const vector<unsigned int>& dimension : nSet)
     {
-      return {};
-    }
-  for (const vector<vector<unsigned int>>::const_iterator dimensionEnd = nSet.end(); ++dimensionIt != dimensionEnd; )
-    {
-      intersection.emplace_back();
-      ++otherDimensionIt;
-      set_intersection(dimensionIt->begin(), dimensionIt->end(), otherDimensionIt->begin(), otherDimensionIt->end(), back_inserter(intersection.back()));
-      if (intersection.back().empty())
+      intersectionDimensionIt->clear();
+      set_intersection(dimension.begin(), dimension.end(), otherDimensionIt->begin(), otherDimensionIt->end(), back_inserter(*intersectionDimensionIt));
+      if (intersectionDimensionIt->empty())
 	{
-	  return {};
+	  return false;
 	}
+      ++intersectionDimensionIt;
+      ++otherDimensionIt;
     }
-  return intersection;
+  return true;
 }
 
 void CandidateVariable::addToRSSVariation(const long long delta)
@@ -126,6 +112,11 @@ void CandidateVariable::addToRSSVariation(const long long delta)
   rssVariation += delta;
 }
 
+void CandidateVariable::setRSSVariation(const long long rssVariationParam)
+{
+  rssVariation = rssVariationParam;
+}
+
 void CandidateVariable::reset()
 {
   rssVariation = static_cast<long long>(-density) * density;
@@ -29,9 +29,10 @@ class CandidateVariable
   long long getRSSVariation() const;
 
   bool overlaps(const vector<vector<unsigned int>>::const_iterator otherDimensionBegin) const;
-  vector<vector<unsigned int>> inter(const vector<vector<unsigned int>>::const_iterator otherDimensionBegin) const;
+  bool inter(const vector<vector<unsigned int>>::const_iterator otherDimensionBegin, vector<vector<unsigned int>>& intersection) const; // intersection, whose buffers are reused, is only complete if true is returned (non-empty intersection)
 
   void addToRSSVariation(const long long delta);
+  void setRSSVariation(const long long rssVariation);
   void reset();
 
 private:
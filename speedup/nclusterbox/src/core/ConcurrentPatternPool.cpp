@@ -12,6 +12,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <iterator>
 #include <random>
 #include <iostream>
 #include <iomanip>
@@ -19,18 +20,34 @@
 
 #include "AbstractRoughTensor.h"
 
-vector<vector<vector<unsigned int>>> ConcurrentPatternPool::patterns;
-mutex ConcurrentPatternPool::patternsLock;
+// Number of consecutive patterns given to a worker before moving on to the next one
+static const unsigned int blockSize = 16;
+
+vector<ConcurrentPatternPool::WorkerPatterns> ConcurrentPatternPool::workerPatterns(1);
+atomic<unsigned int> ConcurrentPatternPool::nbOfWorkersCallingNext(0);
+unsigned int ConcurrentPatternPool::receiverId = 0;
+unsigned int ConcurrentPatternPool::nbOfPatternsInReceiverBlock = 0;
+atomic<unsigned long long> ConcurrentPatternPool::nbOfPatterns(0);
+vector<unsigned int> ConcurrentPatternPool::defaultTuples;
+unsigned int ConcurrentPatternPool::n;
+unsigned long long ConcurrentPatternPool::nbOfDefaultTuples = 0;
+atomic<unsigned long long> ConcurrentPatternPool::nbOfTakenDefaultTuples(0);
+atomic<unsigned int> ConcurrentPatternPool::nbOfIdleWorkers(0);
+mutex ConcurrentPatternPool::idleLock;
 condition_variable ConcurrentPatternPool::cv;
 bool ConcurrentPatternPool::isDefaultInitialPatterns;
 bool ConcurrentPatternPool::isUnboundedNumberOfPatterns;
-bool ConcurrentPatternPool::isAllPatternsAdded;
+atomic<bool> ConcurrentPatternPool::isAllPatternsAdded(false);
 unsigned long long ConcurrentPatternPool::nbOfFreeSlots;
 vector<pair<vector<unsigned int>, double>> ConcurrentPatternPool::tuplesWithHighestMembershipDegrees;
 vector<vector<unsigned int>> ConcurrentPatternPool::additionalTuplesWithLowestAmongHighestMembershipDegrees;
 vector<unsigned int> ConcurrentPatternPool::old2NewDimensionOrder;
 vector<vector<unsigned int>> ConcurrentPatternPool::oldIds2NewIds;
 
+ConcurrentPatternPool::WorkerPatterns::WorkerPatterns(): lock(), patterns()
+{
+}
+
 void ConcurrentPatternPool::setReadFromFile()
 {
   isDefaultInitialPatterns = false;
@@ -160,57 +177,67 @@ bool ConcurrentPatternPool::readFromFile()
   return true;
 }
 
-void ConcurrentPatternPool::addDefaultPattern(const vector<unsigned int>& tuple)
+void ConcurrentPatternPool::setNbOfWorkers(const unsigned int nbOfWorkers)
 {
-  vector<vector<unsigned int>> pattern;
-  const vector<unsigned int>::const_iterator idEnd = tuple.end();
-  vector<unsigned int>::const_iterator idIt = tuple.begin();
-  pattern.reserve(idEnd - idIt);
-  pattern.emplace_back(1, *idIt);
-  ++idIt;
-  do
-    {
-      pattern.emplace_back(1, *idIt);
-    }
-  while (++idIt != idEnd);
-  addPattern(pattern);
+  workerPatterns = vector<WorkerPatterns>(nbOfWorkers);
 }
 
+void ConcurrentPatternPool::addDefaultPattern(const vector<unsigned int>& tuple)
+{
+  n = tuple.size();
+  defaultTuples.insert(defaultTuples.end(), tuple.begin(), tuple.end());
+}
 
 void ConcurrentPatternPool::addRemappedDefaultPattern(const vector<unsigned int>& tuple)
 {
-  const unsigned int n = tuple.size();
-  vector<vector<unsigned int>> pattern(n);
-  pattern[old2NewDimensionOrder.front()].emplace_back(oldIds2NewIds.front()[tuple.front()]);
+  n = tuple.size();
+  defaultTuples.resize(defaultTuples.size() + n);
+  const vector<unsigned int>::iterator remappedTupleBegin = defaultTuples.end() - n;
+  remappedTupleBegin[old2NewDimensionOrder.front()] = oldIds2NewIds.front()[tuple.front()];
   unsigned int oldDimensionId = 1;
   do
     {
-      pattern[old2NewDimensionOrder[oldDimensionId]].emplace_back(oldIds2NewIds[oldDimensionId][tuple[oldDimensionId]]);
+      remappedTupleBegin[old2NewDimensionOrder[oldDimensionId]] = oldIds2NewIds[oldDimensionId][tuple[oldDimensionId]];
     }
   while (++oldDimensionId != n);
-  addPattern(pattern);
 }
 
 void ConcurrentPatternPool::addPattern(vector<vector<unsigned int>>& pattern)
 {
-  patternsLock.lock();
-  patterns.emplace_back(std::move(pattern));
-  patternsLock.unlock();
-  cv.notify_one();
+  ++nbOfPatterns;
+  WorkerPatterns& receiver = workerPatterns[receiverId];
+  receiver.lock.lock();
+  receiver.patterns.emplace_back(std::move(pattern));
+  receiver.lock.unlock();
+  if (++nbOfPatternsInReceiverBlock == blockSize)
+    {
+      nbOfPatternsInReceiverBlock = 0;
+      if (++receiverId == workerPatterns.size())
+	{
+	  receiverId = 0;
+	}
+    }
+  if (nbOfIdleWorkers)
+    {
+      // Locking idleLock guarantees the idle worker that checked nbOfPatterns before its increment is now waiting
+      idleLock.lock();
+      idleLock.unlock();
+      cv.notify_one();
+    }
 }
 
-void ConcurrentPatternPool::addFuzzyTuple(const vector<unsigned int>& tuple, const double shiftedMembership)
+void ConcurrentPatternPool::addFuzzyTuple(const vector<unsigned int>::const_iterator tupleBegin, const vector<unsigned int>::const_iterator tupleEnd, const double shiftedMembership)
 {
   if (isDefaultInitialPatterns && shiftedMembership > 0)
     {
       if (isUnboundedNumberOfPatterns)
 	{
-	  additionalTuplesWithLowestAmongHighestMembershipDegrees.emplace_back(tuple);
+	  additionalTuplesWithLowestAmongHighestMembershipDegrees.emplace_back(tupleBegin, tupleEnd);
 	  return;
 	}
       if (nbOfFreeSlots)
 	{
-	  tuplesWithHighestMembershipDegrees.emplace_back(make_pair(tuple, shiftedMembership));
+	  tuplesWithHighestMembershipDegrees.emplace_back(vector<unsigned int>(tupleBegin, tupleEnd), shiftedMembership);
 	  if (!--nbOfFreeSlots)
 	    {
 	      make_heap(tuplesWithHighestMembershipDegrees.begin(), tuplesWithHighestMembershipDegrees.end(), [](const pair<vector<unsigned int>, double>& fuzzyTuple1, const pair<vector<unsigned int>, double>& fuzzyTuple2) { return fuzzyTuple1.second > fuzzyTuple2.second; });
@@ -222,7 +249,7 @@ void ConcurrentPatternPool::addFuzzyTuple(const vector<unsigned int>& tuple, con
       if (lowestAmongHighestMembershipDegrees < shiftedMembership)
 	{
 	  tuplesWithHighestMembershipDegrees.pop_back();
-	  tuplesWithHighestMembershipDegrees.emplace_back(make_pair(tuple, shiftedMembership));
+	  tuplesWithHighestMembershipDegrees.emplace_back(vector<unsigned int>(tupleBegin, tupleEnd), shiftedMembership);
 	  pop_heap(tuplesWithHighestMembershipDegrees.begin(), tuplesWithHighestMembershipDegrees.end(), [](const pair<vector<unsigned int>, double>& fuzzyTuple1, const pair<vector<unsigned int>, double>& fuzzyTuple2) { return fuzzyTuple1.second > fuzzyTuple2.second; });
 	  if (tuplesWithHighestMembershipDegrees.back().second != lowestAmongHighestMembershipDegrees)
 	    {
@@ -232,15 +259,23 @@ void ConcurrentPatternPool::addFuzzyTuple(const vector<unsigned int>& tuple, con
 	}
       if (lowestAmongHighestMembershipDegrees == shiftedMembership)
 	{
-	  additionalTuplesWithLowestAmongHighestMembershipDegrees.emplace_back(tuple);
+	  additionalTuplesWithLowestAmongHighestMembershipDegrees.emplace_back(tupleBegin, tupleEnd);
 	}
     }
 }
 
 void ConcurrentPatternPool::allPatternsAdded()
 {
+  if (!defaultTuples.empty())
+    {
+      // publish the default patterns at once, the workers taking them by incrementing nbOfTakenDefaultTuples
+      nbOfDefaultTuples = defaultTuples.size() / n;
+      nbOfPatterns = nbOfDefaultTuples;
+    }
   isAllPatternsAdded = true;
-  cv.notify_one();
+  idleLock.lock();
+  idleLock.unlock();
+  cv.notify_all();
 }
 
 void ConcurrentPatternPool::setNewDimensionOrderAndNewIds(const vector<unsigned int>& old2NewDimensionOrderParam, const vector<vector<pair<double, unsigned int>>>& elementPositiveMemberships)
@@ -258,55 +293,139 @@ void ConcurrentPatternPool::setNewDimensionOrderAndNewIds(const vector<unsigned
   while (++elementPositiveMembershipsInDimensionIt != elementPositiveMembershipsInDimensionEnd);
 }
 
-vector<vector<unsigned int>> ConcurrentPatternPool::next()
+bool ConcurrentPatternPool::nextBatch(const unsigned int maxNbOfPatterns, vector<vector<vector<unsigned int>>>& batch)
 {
-  if (isAllPatternsAdded)
+  static thread_local const unsigned int workerId = nbOfWorkersCallingNext++ % workerPatterns.size();
+  for (; ; )
     {
-      const lock_guard<mutex> lock(patternsLock);
-      if (patterns.empty())
+      if (nbOfPatterns && (isDefaultInitialPatterns ? takeDefaultPatterns(maxNbOfPatterns, batch) : take(workerId, maxNbOfPatterns, batch)))
+	{
+	  return true;
+	}
+      if (isAllPatternsAdded)
 	{
-	  return {};
+	  if (!nbOfPatterns)
+	    {
+	      return false;
+	    }
+	  // another worker is about to decrement nbOfPatterns or a thief took the patterns this worker had seen
+	  this_thread::yield();
+	}
+      else
+	{
+	  unique_lock<mutex> lock(idleLock);
+	  ++nbOfIdleWorkers;
+	  cv.wait(lock, []{ return nbOfPatterns || isAllPatternsAdded; });
+	  --nbOfIdleWorkers;
 	}
-      const vector<vector<unsigned int>> pattern = std::move(patterns.back());
-      patterns.pop_back();
-      return pattern;
     }
-  unique_lock<mutex> lock(patternsLock);
-  if (patterns.empty())
+}
+
+unsigned int ConcurrentPatternPool::batchSize(const unsigned int maxNbOfPatterns)
+{
+  // guided self-scheduling: large batches while many patterns remain, smaller ones towards the end to balance the load
+  const unsigned long long fairShare = nbOfPatterns / (2 * workerPatterns.size());
+  if (fairShare == 0)
+    {
+      return 1;
+    }
+  if (fairShare < maxNbOfPatterns)
+    {
+      return fairShare;
+    }
+  return maxNbOfPatterns;
+}
+
+bool ConcurrentPatternPool::takeDefaultPatterns(const unsigned int maxNbOfPatterns, vector<vector<vector<unsigned int>>>& batch)
+{
+  const unsigned long long size = batchSize(maxNbOfPatterns);
+  const unsigned long long begin = nbOfTakenDefaultTuples.fetch_add(size);
+  if (begin >= nbOfDefaultTuples)
     {
-      cv.wait(lock, []{ return !patterns.empty() || isAllPatternsAdded; });
-      if (patterns.empty())
+      return false;
+    }
+  const unsigned long long end = min(begin + size, nbOfDefaultTuples);
+  // Resizing, rather than clearing, batch keeps the buffers of the previous batch: in steady state, no memory is allocated
+  batch.resize(end - begin);
+  vector<unsigned int>::const_iterator idIt = defaultTuples.begin() + begin * n;
+  for (vector<vector<unsigned int>>& pattern : batch)
+    {
+      pattern.resize(n);
+      for (vector<unsigned int>& dimension : pattern)
 	{
-	  lock.unlock();
-	  cv.notify_one();
-	  return {};
+	  dimension.assign(1, *idIt++);
+	}
+    }
+  nbOfPatterns -= end - begin;
+  return true;
+}
+
+bool ConcurrentPatternPool::take(const unsigned int workerId, const unsigned int maxNbOfPatterns, vector<vector<vector<unsigned int>>>& batch)
+{
+  const unsigned int size = batchSize(maxNbOfPatterns);
+  {
+    // Last patterns of the worker
+    WorkerPatterns& own = workerPatterns[workerId];
+    const lock_guard<mutex> lock(own.lock);
+    if (!own.patterns.empty())
+      {
+	batch.clear();
+	const unsigned int nbOfTakenPatterns = min(static_cast<size_t>(size), own.patterns.size());
+	move(own.patterns.end() - nbOfTakenPatterns, own.patterns.end(), back_inserter(batch));
+	own.patterns.erase(own.patterns.end() - nbOfTakenPatterns, own.patterns.end());
+	nbOfPatterns -= nbOfTakenPatterns;
+	return true;
+      }
+  }
+  // First patterns of another worker, at most half of them
+  const unsigned int nbOfWorkers = workerPatterns.size();
+  for (unsigned int victimId = workerId + 1; ; ++victimId)
+    {
+      if (victimId == nbOfWorkers)
+	{
+	  victimId = 0;
+	}
+      if (victimId == workerId)
+	{
+	  return false;
+	}
+      WorkerPatterns& victim = workerPatterns[victimId];
+      const lock_guard<mutex> lock(victim.lock);
+      if (!victim.patterns.empty())
+	{
+	  batch.clear();
+	  const unsigned int nbOfTakenPatterns = min(static_cast<size_t>(size), (victim.patterns.size() + 1) / 2);
+	  move(victim.patterns.begin(), victim.patterns.begin() + nbOfTakenPatterns, back_inserter(batch));
+	  victim.patterns.erase(victim.patterns.begin(), victim.patterns.begin() + nbOfTakenPatterns);
+	  nbOfPatterns -= nbOfTakenPatterns;
+	  return true;
 	}
     }
-  const vector<vector<unsigned int>> pattern = std::move(patterns.back());
-  patterns.pop_back();
-  lock.unlock();
-  cv.notify_one();
-  return pattern;
 }
 
 void ConcurrentPatternPool::moveTo(vector<vector<vector<unsigned int>>>& candidateVariables)
 {
-  candidateVariables = std::move(patterns);
+  candidateVariables.reserve(nbOfPatterns);
+  for (WorkerPatterns& worker : workerPatterns)
+    {
+      move(worker.patterns.begin(), worker.patterns.end(), back_inserter(candidateVariables));
+      worker.patterns.clear();
+    }
+  nbOfPatterns = 0;
 }
 
 void ConcurrentPatternPool::printProgressionOnSTDIN(const float stepInSeconds)
 {
   cout << "\rGetting initial patterns: done.           \n";
-  unsigned int nbOfDigitsInNbOfPatterns = patterns.size();
+  unsigned int nbOfDigitsInNbOfPatterns = nbOfPatterns;
   if (nbOfDigitsInNbOfPatterns)
     {
       nbOfDigitsInNbOfPatterns = log10(nbOfDigitsInNbOfPatterns);
       ++nbOfDigitsInNbOfPatterns;
       const chrono::duration<float> duration(stepInSeconds);
-      // I believe locking patternsLock is unnecessary
-      while (!patterns.empty())
+      while (nbOfPatterns)
 	{
-	  cout << "\rStill " << right << setw(nbOfDigitsInNbOfPatterns) << patterns.size() << " patterns to start modifying" << flush;
+	  cout << "\rStill " << right << setw(nbOfDigitsInNbOfPatterns) << nbOfPatterns << " patterns to start modifying" << flush;
 	  this_thread::sleep_for(duration);
 	}
     }
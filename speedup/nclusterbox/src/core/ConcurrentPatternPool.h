@@ -12,6 +12,8 @@
 #define CONCURRENT_PATTERN_POOL_H_
 
 #include <vector>
+#include <deque>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
@@ -23,23 +25,42 @@ class ConcurrentPatternPool
   static void setReadFromFile();
   static void setDefaultPatterns(const unsigned long long maxNbOfPatterns);
   static bool readFromFile();
+  static void setNbOfWorkers(const unsigned int nbOfWorkers);
 
   static void addPattern(vector<vector<unsigned int>>& pattern);
-  static void addFuzzyTuple(const vector<unsigned int>& tuple, const double shiftedMembership);
+  static void addFuzzyTuple(const vector<unsigned int>::const_iterator tupleBegin, const vector<unsigned int>::const_iterator tupleEnd, const double shiftedMembership);
   static void setNewDimensionOrderAndNewIds(const vector<unsigned int>& old2NewDimensionOrder, const vector<vector<pair<double, unsigned int>>>& elementPositiveMemberships);
   static void allPatternsAdded();
-  static vector<vector<unsigned int>> next();
+  static bool nextBatch(const unsigned int maxNbOfPatterns, vector<vector<vector<unsigned int>>>& batch); /* replaces the content of batch, whose buffers are reused for the default patterns; false if every pattern was taken */
   static void moveTo(vector<vector<vector<unsigned int>>>& candidateVariables);
 
   static void printProgressionOnSTDIN(const float stepInSeconds);
 
  private:
-  static vector<vector<vector<unsigned int>>> patterns;
-  static mutex patternsLock;
+  /* the patterns of one worker, which pops the last one, the other workers stealing the first one; aligned on a cache line so that the locks of two workers never share one */
+  struct alignas(64) WorkerPatterns
+  {
+    mutex lock;
+    deque<vector<vector<unsigned int>>> patterns;
+
+    WorkerPatterns();
+  };
+
+  static vector<WorkerPatterns> workerPatterns;
+  static atomic<unsigned int> nbOfWorkersCallingNext;
+  static unsigned int receiverId; /* only accessed by the thread adding the patterns */
+  static unsigned int nbOfPatternsInReceiverBlock; /* only accessed by the thread adding the patterns */
+  static atomic<unsigned long long> nbOfPatterns; /* incremented before the pattern is stored, decremented after it is taken */
+  static vector<unsigned int> defaultTuples; /* the default patterns, as consecutive tuples in the internal dimension order; only read once allPatternsAdded published them */
+  static unsigned int n; /* size of a tuple in defaultTuples */
+  static unsigned long long nbOfDefaultTuples;
+  static atomic<unsigned long long> nbOfTakenDefaultTuples;
+  static atomic<unsigned int> nbOfIdleWorkers;
+  static mutex idleLock;
   static condition_variable cv;
   static bool isDefaultInitialPatterns;
   static bool isUnboundedNumberOfPatterns;
-  static bool isAllPatternsAdded;
+  static atomic<bool> isAllPatternsAdded;
   static unsigned long long nbOfFreeSlots;
   static vector<pair<vector<unsigned int>, double>> tuplesWithHighestMembershipDegrees;
   static vector<vector<unsigned int>> additionalTuplesWithLowestAmongHighestMembershipDegrees;
@@ -49,6 +70,9 @@ class ConcurrentPatternPool
   static vector<unsigned int> oldIds2NewIdsInDimension(const vector<pair<double, unsigned int>>& elements);
   static void addDefaultPattern(const vector<unsigned int>& tuple);
   static void addRemappedDefaultPattern(const vector<unsigned int>& tuple);
+  static unsigned int batchSize(const unsigned int maxNbOfPatterns);
+  static bool takeDefaultPatterns(const unsigned int maxNbOfPatterns, vector<vector<vector<unsigned int>>>& batch);
+  static bool take(const unsigned int workerId, const unsigned int maxNbOfPatterns, vector<vector<vector<unsigned int>>>& batch);
 };
 
 #endif /*CONCURRENT_PATTERN_POOL_H_*/
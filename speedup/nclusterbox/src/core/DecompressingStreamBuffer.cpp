@@ -0,0 +1,227 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "DecompressingStreamBuffer.h"
+
+#include <cstring>
+#include <algorithm>
+#include <ios>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filter/lzma.hpp>
+
+#include "../utilities/NoInputException.h"
+
+static const char gzipMagicNumber[] = {'\x1f', '\x8b'};
+static const char zstdMagicNumber[] = {'\x28', '\xb5', '\x2f', '\xfd'};
+static const char xzMagicNumber[] = {'\xfd', '7', 'z', 'X', 'Z', '\0'};
+
+static bool startsWith(const char* begin, const char* end, const char* magicNumber, const size_t magicNumberSize)
+{
+  return static_cast<size_t>(end - begin) >= magicNumberSize && memcmp(begin, magicNumber, magicNumberSize) == 0;
+}
+
+DecompressingStreamBuffer::Source::Source(const int fileDescriptorParam, const string& startParam, const atomic<bool>& isStoppedParam): fileDescriptor(fileDescriptorParam), start(startParam), startOffset(0), isStopped(isStoppedParam)
+{
+}
+
+streamsize DecompressingStreamBuffer::Source::read(char* s, streamsize n)
+{
+  if (startOffset != start.size())
+    {
+      const size_t nbOfCopiedBytes = min(static_cast<size_t>(n), start.size() - startOffset);
+      memcpy(s, start.data() + startOffset, nbOfCopiedBytes);
+      startOffset += nbOfCopiedBytes;
+      return nbOfCopiedBytes;
+    }
+  // A standard input or a pipe may never get more characters: waiting for them with a timeout lets the destructor stop producer
+  pollfd descriptor = {fileDescriptor, POLLIN, 0};
+  for (; ; )
+    {
+      if (isStopped.load(memory_order_relaxed))
+	{
+	  return -1;
+	}
+      const int nbOfReadyDescriptors = poll(&descriptor, 1, pollingPeriod);
+      if (nbOfReadyDescriptors == 1)
+	{
+	  break;
+	}
+      if (nbOfReadyDescriptors == -1 && errno != EINTR)
+	{
+	  throw ios_base::failure("poll error");
+	}
+    }
+  const ssize_t nbOfReadBytes = ::read(fileDescriptor, s, n);
+  if (nbOfReadBytes == -1)
+    {
+      throw ios_base::failure("read error");
+    }
+  if (nbOfReadBytes == 0)
+    {
+      return -1;
+    }
+  return nbOfReadBytes;
+}
+
+DecompressingStreamBuffer::DecompressingStreamBuffer(const char* fileNameParam, const int fileDescriptorParam, string&& startParam): streambuf(), fileName(fileNameParam), fileDescriptor(fileDescriptorParam), start(std::move(startParam)), ring(nbOfBlocks), firstFullBlockId(0), nbOfFullBlocks(0), isEnd(false), isError(false), isStopped(false), ringMutex(), ringNotEmpty(), ringNotFull(), currentBlock(), producer(&DecompressingStreamBuffer::produce, this)
+{
+}
+
+DecompressingStreamBuffer::~DecompressingStreamBuffer()
+{
+  {
+    lock_guard<mutex> lock(ringMutex);
+    isStopped.store(true, memory_order_relaxed);
+  }
+  // producer stops waiting for room in ring or, within pollingPeriod milliseconds, for characters to read
+  ringNotFull.notify_one();
+  producer.join();
+  if (fileDescriptor != STDIN_FILENO)
+    {
+      close(fileDescriptor);
+    }
+}
+
+DecompressingStreamBuffer* DecompressingStreamBuffer::open(const char* fileName)
+{
+  int fileDescriptor = STDIN_FILENO;
+  if (string(fileName) != "-")
+    {
+      fileDescriptor = ::open(fileName, O_RDONLY);
+      if (fileDescriptor == -1)
+	{
+	  throw NoInputException(fileName);
+	}
+    }
+  // Read enough characters to recognize any magic number
+  const off_t startPosition = lseek(fileDescriptor, 0, SEEK_CUR);
+  string start(sizeof(xzMagicNumber), '\0');
+  size_t startSize = 0;
+  for (ssize_t nbOfReadBytes = ::read(fileDescriptor, &start.front(), start.size()); nbOfReadBytes > 0 && (startSize += nbOfReadBytes) != start.size(); nbOfReadBytes = ::read(fileDescriptor, &start.front() + startSize, start.size() - startSize))
+    {
+    }
+  start.resize(startSize);
+  if (!isCompressed(start.data(), start.data() + startSize) && startPosition != -1 && lseek(fileDescriptor, startPosition, SEEK_SET) == startPosition)
+    {
+      if (fileDescriptor != STDIN_FILENO)
+	{
+	  close(fileDescriptor);
+	}
+      return nullptr;
+    }
+  // Compressed or, if the start cannot be put back, a pipe whose characters are merely copied
+  return new DecompressingStreamBuffer(fileName, fileDescriptor, std::move(start));
+}
+
+bool DecompressingStreamBuffer::isCompressed(const char* begin, const char* end)
+{
+  return startsWith(begin, end, gzipMagicNumber, sizeof(gzipMagicNumber)) || startsWith(begin, end, zstdMagicNumber, sizeof(zstdMagicNumber)) || startsWith(begin, end, xzMagicNumber, sizeof(xzMagicNumber));
+}
+
+bool DecompressingStreamBuffer::getBlock(string& block)
+{
+  unique_lock<mutex> lock(ringMutex);
+  ringNotEmpty.wait(lock, [this]() { return nbOfFullBlocks || isEnd; });
+  if (!nbOfFullBlocks)
+    {
+      if (isError)
+	{
+	  throw NoInputException(fileName.c_str());
+	}
+      return false;
+    }
+  block.swap(ring[firstFullBlockId]);
+  if (++firstFullBlockId == nbOfBlocks)
+    {
+      firstFullBlockId = 0;
+    }
+  --nbOfFullBlocks;
+  ringNotFull.notify_one();
+  return true;
+}
+
+DecompressingStreamBuffer::int_type DecompressingStreamBuffer::underflow()
+{
+  if (!getBlock(currentBlock))
+    {
+      return traits_type::eof();
+    }
+  char* const blockBegin = &currentBlock.front();
+  setg(blockBegin, blockBegin, blockBegin + currentBlock.size());
+  return traits_type::to_int_type(*blockBegin);
+}
+
+void DecompressingStreamBuffer::produce()
+{
+  try
+    {
+      boost::iostreams::filtering_istreambuf decompressedBuffer;
+      const char* const startEnd = start.data() + start.size();
+      if (startsWith(start.data(), startEnd, gzipMagicNumber, sizeof(gzipMagicNumber)))
+	{
+	  decompressedBuffer.push(boost::iostreams::gzip_decompressor());
+	}
+      else
+	{
+	  if (startsWith(start.data(), startEnd, zstdMagicNumber, sizeof(zstdMagicNumber)))
+	    {
+	      decompressedBuffer.push(boost::iostreams::zstd_decompressor());
+	    }
+	  else
+	    {
+	      if (startsWith(start.data(), startEnd, xzMagicNumber, sizeof(xzMagicNumber)))
+		{
+		  decompressedBuffer.push(boost::iostreams::lzma_decompressor());
+		}
+	    }
+	}
+      decompressedBuffer.push(Source(fileDescriptor, start, isStopped));
+      string block;
+      for (; ; )
+	{
+	  block.resize(blockSize);
+	  const streamsize blockLength = decompressedBuffer.sgetn(&block.front(), blockSize);
+	  if (blockLength <= 0)
+	    {
+	      break;
+	    }
+	  block.resize(blockLength);
+	  unique_lock<mutex> lock(ringMutex);
+	  ringNotFull.wait(lock, [this]() { return nbOfFullBlocks != nbOfBlocks || isStopped; });
+	  if (isStopped)
+	    {
+	      return;
+	    }
+	  size_t lastBlockId = firstFullBlockId + nbOfFullBlocks;
+	  if (lastBlockId >= nbOfBlocks)
+	    {
+	      lastBlockId -= nbOfBlocks;
+	    }
+	  ring[lastBlockId].swap(block);
+	  ++nbOfFullBlocks;
+	  ringNotEmpty.notify_one();
+	}
+    }
+  catch (...)
+    {
+      // Corrupted compressed data or read error: reported by getBlock after the blocks decompressed so far
+      lock_guard<mutex> lock(ringMutex);
+      isError = true;
+    }
+  lock_guard<mutex> lock(ringMutex);
+  isEnd = true;
+  ringNotEmpty.notify_one();
+}
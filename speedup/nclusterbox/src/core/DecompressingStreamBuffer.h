@@ -0,0 +1,83 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef DECOMPRESSING_STREAM_BUFFER_H_
+#define DECOMPRESSING_STREAM_BUFFER_H_
+
+#include <string>
+#include <vector>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <boost/iostreams/categories.hpp>
+
+using namespace std;
+
+class DecompressingStreamBuffer final : public streambuf
+{
+ public:
+  DecompressingStreamBuffer(const DecompressingStreamBuffer& otherDecompressingStreamBuffer) = delete;
+  ~DecompressingStreamBuffer();
+
+  DecompressingStreamBuffer& operator=(const DecompressingStreamBuffer& otherDecompressingStreamBuffer) = delete;
+
+  bool getBlock(string& block);	/* swaps block with the next block of decompressed characters, which is never empty, or returns false at the end of the file; not to be mixed with the istream interface */
+
+  static DecompressingStreamBuffer* open(const char* fileName); /* "-" is the standard input; returns nullptr if the file is neither compressed (with gzip, zstd or xz) nor a pipe, i.e., if it can be read as usual */
+  static bool isCompressed(const char* begin, const char* end); /* by the magic number at begin */
+
+ protected:
+  int_type underflow();
+
+ private:
+  class Source
+  {
+  public:
+    typedef char char_type;
+    typedef boost::iostreams::source_tag category;
+
+    Source(const int fileDescriptor, const string& start, const atomic<bool>& isStopped);
+
+    streamsize read(char* s, streamsize n); /* waits for characters by periods of at most pollingPeriod milliseconds, returning the end of the file once isStopped */
+
+  private:
+    int fileDescriptor;
+    string start;		/* characters already read from fileDescriptor, to detect the compression */
+    size_t startOffset;
+    const atomic<bool>& isStopped;
+  };
+
+  const string fileName;
+  const int fileDescriptor;
+  const string start;
+  vector<string> ring;		/* blocks decompressed by producer and not yet consumed */
+  size_t firstFullBlockId;
+  size_t nbOfFullBlocks;
+  bool isEnd;
+  bool isError;
+  atomic<bool> isStopped;	/* set by the destructor, also under ringMutex to wake up producer */
+  mutex ringMutex;
+  condition_variable ringNotEmpty;
+  condition_variable ringNotFull;
+  string currentBlock;		/* get area of the istream interface */
+  thread producer;
+
+  static constexpr size_t blockSize = 1 << 20;
+  static constexpr size_t nbOfBlocks = 4;
+  static constexpr int pollingPeriod = 100;
+
+  DecompressingStreamBuffer(const char* fileName, const int fileDescriptor, string&& start); /* start was read from fileDescriptor, which is closed at destruction unless it is the standard input */
+
+  void produce();
+};
+
+#endif /*DECOMPRESSING_STREAM_BUFFER_H_*/
@@ -10,33 +10,41 @@
 
 #include "DenseCrispTube.h"
 
+#include "FlatTrie.h"
+#include "VectorizedSums.h"
+
 unsigned int DenseCrispTube::size;
 
-DenseCrispTube::DenseCrispTube(vector<double>::const_iterator& membershipIt): tube(size)
+DenseCrispTube::DenseCrispTube(vector<double>::const_iterator& membershipIt): tube((size + 63) / 64)
 {
   unsigned int elementId = 0;
   do
     {
       if (*membershipIt > 0)
 	{
-	  tube.set(elementId);
+	  tube[elementId / 64] |= 1ull << elementId % 64;
 	}
       ++membershipIt;
     }
   while (++elementId != size);
 }
 
-DenseCrispTube::DenseCrispTube(const vector<unsigned int>& sparseTube): tube(size)
+DenseCrispTube::DenseCrispTube(const vector<unsigned int>& sparseTube): tube((size + 63) / 64)
 {
   for (const unsigned int elementId : sparseTube)
     {
-      tube.set(elementId);
+      tube[elementId / 64] |= 1ull << elementId % 64;
     }
 }
 
 void DenseCrispTube::setTuple(const vector<unsigned int>::const_iterator idIt)
 {
-  tube.set(*idIt);
+  tube[*idIt / 64] |= 1ull << *idIt % 64;
+}
+
+void DenseCrispTube::flatten(FlatTrie& flatTrie)
+{
+  flatTrie.addDenseCrispTube(tube);
 }
 
 void DenseCrispTube::sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& nbOfPresentTuples) const
@@ -45,10 +53,7 @@ void DenseCrispTube::sumOnPattern(const vector<vector<unsigned int>>::const_iter
   vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
   do
     {
-      if (tube[*idIt])
-	{
-	  ++nbOfPresentTuples;
-	}
+      nbOfPresentTuples += tube[*idIt / 64] >> *idIt % 64 & 1;
     }
   while (++idIt != idEnd);
 }
@@ -60,65 +65,26 @@ void DenseCrispTube::setSize(const unsigned int sizeParam)
 
 int DenseCrispTube::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator numbersOfPresentTuplesIt) const
 {
+  VectorizedSums::increment(tube.data(), size, numbersOfPresentTuplesIt->data());
   int sumOnPattern = 0;
-  dynamic_bitset<>::size_type elementId = tube.find_first();
-  {
-    // Hyperplanes until the last present one
-    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
-    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
-    unsigned int presentElementId = *presentElementIdIt;
-    for (; elementId != dynamic_bitset<>::npos; elementId = tube.find_next(elementId))
-      {
-	++((*numbersOfPresentTuplesIt)[elementId]);
-	if (elementId >= presentElementId)
-	  {
-	    if (elementId == presentElementId)
-	      {
-		++sumOnPattern;
-		if (++presentElementIdIt == presentElementIdEnd)
-		  {
-		    break;
-		  }
-	      }
-	    else
-	      {
-		presentElementIdIt = lower_bound(++presentElementIdIt, presentElementIdEnd, elementId);
-		if (presentElementIdIt == presentElementIdEnd)
-		  {
-		    break;
-		  }
-		if (elementId == *presentElementIdIt)
-		  {
-		    ++sumOnPattern;
-		    if (++presentElementIdIt == presentElementIdEnd)
-		      {
-			break;
-		      }
-		  }
-	      }
-	    presentElementId = *presentElementIdIt;
-	  }
-      }
-  }
-  // Hyperplanes after the last present one
-  for (elementId = tube.find_next(elementId); elementId != dynamic_bitset<>::npos; elementId = tube.find_next(elementId))
+  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
+  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
+  do
     {
-      ++((*numbersOfPresentTuplesIt)[elementId]);
+      sumOnPattern += tube[*idIt / 64] >> *idIt % 64 & 1;
     }
+  while (++idIt != idEnd);
   return sumOnPattern;
 }
 
 void DenseCrispTube::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   // n == 2 and first dimension increased
-  for (dynamic_bitset<>::size_type elementId = tube.find_first(); elementId != dynamic_bitset<>::npos; elementId = tube.find_next(elementId))
-    {
-      ++((*sumsIt)[elementId]);
-    }
+  VectorizedSums::increment(tube.data(), size, sumsIt->data());
 }
 
 int DenseCrispTube::increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   // necessarily the increased dimension
-  return tube[dimensionIt->front()];
+  return tube[dimensionIt->front() / 64] >> dimensionIt->front() % 64 & 1;
 }
@@ -11,12 +11,8 @@
 #ifndef DENSE_CRISP_TUBE_H_
 #define DENSE_CRISP_TUBE_H_
 
-#include <boost/dynamic_bitset.hpp>
-
 #include "AbstractData.h"
 
-using namespace boost;
-
 class DenseCrispTube final : public AbstractData
 {
  public:
@@ -24,6 +20,7 @@ class DenseCrispTube final : public AbstractData
   DenseCrispTube(const vector<unsigned int>& sparseTube);
 
   void setTuple(const vector<unsigned int>::const_iterator idIt);
+  void flatten(FlatTrie& flatTrie);
 
   void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& nbOfPresentTuples) const;
   int sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator numbersOfPresentTuplesIt) const;
@@ -33,8 +30,7 @@ class DenseCrispTube final : public AbstractData
   static void setSize(const unsigned int size);
 
  private:
-  dynamic_bitset<> tube;		/* indicates the presence of the shifted tuple */
-  /* TODO: test whether storing is faster than computing tube.find_first() every time it is needed */
+  vector<unsigned long long> tube; /* bit elementId % 64 of tube[elementId / 64] indicates the presence of the shifted tuple */
 
   static unsigned int size;
 };
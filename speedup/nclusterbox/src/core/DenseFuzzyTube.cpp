@@ -10,6 +10,9 @@
 
 #include "DenseFuzzyTube.h"
 
+#include "FlatTrie.h"
+#include "VectorizedSums.h"
+
 unsigned int DenseFuzzyTube::size;
 
 DenseFuzzyTube::DenseFuzzyTube(vector<double>::const_iterator& membershipIt, const int unit): tube()
@@ -36,6 +39,11 @@ void DenseFuzzyTube::setTuple(const vector<unsigned int>::const_iterator idIt, c
   tube[*idIt] = membership;
 }
 
+void DenseFuzzyTube::flatten(FlatTrie& flatTrie)
+{
+  flatTrie.addDenseFuzzyTube(tube);
+}
+
 void DenseFuzzyTube::sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
 {
   const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
@@ -65,82 +73,42 @@ void DenseFuzzyTube::setSize(const unsigned int sizeParam)
 
 int DenseFuzzyTube::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
+  VectorizedSums::add(tube.data(), tube.size(), sumsIt->data());
   int sumOnPattern = 0;
-  vector<int>::iterator sumIt = sumsIt->begin();
-  vector<int>::const_iterator tubeIt;
-  {
-    // Hyperplanes until the last present one
-    const vector<int>::const_iterator tubeBegin = tube.begin();
-    tubeIt = tubeBegin;
-    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
-    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
-    do
-      {
-	for (const vector<int>::const_iterator end = tubeBegin + *presentElementIdIt; tubeIt != end; ++tubeIt)
-	  {
-	    *sumIt++ += *tubeIt;
-	  }
-	*sumIt++ += *tubeIt;
-	sumOnPattern += *tubeIt++;
-      }
-    while (++presentElementIdIt != presentElementIdEnd);
-  }
-  // Hyperplanes after the last present one
-  for (const vector<int>::const_iterator tubeEnd = tube.end(); tubeIt != tubeEnd; ++tubeIt)
+  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
+  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
+  do
     {
-      *sumIt++ += *tubeIt;
+      sumOnPattern += tube[*idIt];
     }
+  while (++idIt != idEnd);
   return sumOnPattern;
 }
 
 int DenseFuzzyTube::minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
+  VectorizedSums::subtract(tube.data(), tube.size(), sumsIt->data());
   int sumOnPattern = 0;
-  vector<int>::iterator sumIt = sumsIt->begin();
-  vector<int>::const_iterator tubeIt;
-  {
-    // Hyperplanes until the last present one
-    const vector<int>::const_iterator tubeBegin = tube.begin();
-    tubeIt = tubeBegin;
-    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
-    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
-    do
-      {
-	for (const vector<int>::const_iterator end = tubeBegin + *presentElementIdIt; tubeIt != end; ++tubeIt)
-	  {
-	    *sumIt++ -= *tubeIt;
-	  }
-	*sumIt++ -= *tubeIt;
-	sumOnPattern += *tubeIt++;
-      }
-    while (++presentElementIdIt != presentElementIdEnd);
-  }
-  // Hyperplanes after the last present one
-  for (const vector<int>::const_iterator tubeEnd = tube.end(); tubeIt != tubeEnd; ++tubeIt)
+  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
+  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
+  do
     {
-      *sumIt++ -= *tubeIt;
+      sumOnPattern += tube[*idIt];
     }
+  while (++idIt != idEnd);
   return sumOnPattern;
 }
 
 void DenseFuzzyTube::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   // n == 2 and first dimension increased
-  vector<int>::iterator sumIt = sumsIt->begin();
-  for (const int membership : tube)
-    {
-      *sumIt++ += membership;
-    }
+  VectorizedSums::add(tube.data(), tube.size(), sumsIt->data());
 }
 
 void DenseFuzzyTube::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   // n == 2 and first dimension decreased
-  vector<int>::iterator sumIt = sumsIt->begin();
-  for (const int membership : tube)
-    {
-      *sumIt++ -= membership;
-    }
+  VectorizedSums::subtract(tube.data(), tube.size(), sumsIt->data());
 }
 
 int DenseFuzzyTube::increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
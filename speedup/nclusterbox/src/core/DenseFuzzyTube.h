@@ -20,6 +20,7 @@ class DenseFuzzyTube final : public AbstractData
   DenseFuzzyTube(const vector<pair<unsigned int, int>>& sparseTube, const int defaultMembership);
 
   void setTuple(const vector<unsigned int>::const_iterator idIt, const int membership);
+  void flatten(FlatTrie& flatTrie);
 
   void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
   void minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
@@ -49,13 +49,13 @@ vector<pair<double, unsigned int>> presences2Memberships(const vector<vector<pai
 
 DenseRoughTensor::DenseRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01, const bool isVerbose): shift(), memberships()
 {
-  vector<FuzzyTuple> fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, isVerbose);
+  FuzzyTupleArray fuzzyTuples = getFuzzyTuples(tensorFileName, inputDimensionSeparator, inputElementSeparator, isInput01, isVerbose);
   Trie::is01 = false;
   shift = new ExpectationShift(fuzzyTuples, ids2Labels);
   init(fuzzyTuples);
 }
 
-DenseRoughTensor::DenseRoughTensor(vector<FuzzyTuple>& fuzzyTuples, const double constantShift): shift(new ConstantShift(constantShift)), memberships()
+DenseRoughTensor::DenseRoughTensor(FuzzyTupleArray& fuzzyTuples, const double constantShift): shift(new ConstantShift(constantShift)), memberships()
 {
   init(fuzzyTuples);
   if (Trie::is01)
@@ -69,14 +69,15 @@ DenseRoughTensor::~DenseRoughTensor()
   delete shift;
 }
 
-void DenseRoughTensor::init(vector<FuzzyTuple>& fuzzyTuples)
+void DenseRoughTensor::init(FuzzyTupleArray& fuzzyTuples)
 {
   nullModelRSS = 0;
   // Initialize tuple and positive/negative memberships of the elements
   vector<double> shiftedMemberships;
   unsigned long long nbOfTuples;
+  const unsigned int n = ids2Labels.size();
   vector<unsigned int> tuple;
-  tuple.reserve(ids2Labels.size());
+  tuple.reserve(n);
   double minElementNegativeMembership;
   vector<vector<pair<double, unsigned int>>> elementPositiveMemberships;
   elementPositiveMemberships.reserve(ids2Labels.size());
@@ -106,26 +107,25 @@ void DenseRoughTensor::init(vector<FuzzyTuple>& fuzzyTuples)
       vector<double>::reverse_iterator shiftedMembershipIt = shiftedMemberships.rbegin(); // filled backwards, so that in lexicographic order of the tuples
       const double constantShift = -shift->getShift(tuple); // necessary constant (otherwise !is01)
       minElementNegativeMembership = constantShift * (nbOfTuples / minCardinality);
-      const vector<FuzzyTuple>::const_iterator end = --fuzzyTuples.end();
-      vector<FuzzyTuple>::const_iterator fuzzyTupleIt = fuzzyTuples.begin();
-      do
+      const size_t lastTupleId = fuzzyTuples.size() - 1;
+      size_t tupleId = 0;
+      for (; tupleId != lastTupleId; ++tupleId)
 	{
 	  // Comparing in the reverse order because the last ids are more likely to be different
-	  while (!equal(tuple.rbegin(), tuple.rend(), fuzzyTupleIt->getTuple().rbegin()))
+	  while (!equal(tuple.rbegin(), tuple.rend(), make_reverse_iterator(fuzzyTuples.getTuple(tupleId) + n)))
 	    {
 	      *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, constantShift, elementPresences);
 	    }
-	  ConcurrentPatternPool::addFuzzyTuple(tuple, fuzzyTupleIt->getMembership() + constantShift);
-	  *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, fuzzyTupleIt->getMembership() + constantShift, elementPresences);
+	  ConcurrentPatternPool::addFuzzyTuple(tuple.begin(), tuple.end(), fuzzyTuples.getMembership(tupleId) + constantShift);
+	  *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, fuzzyTuples.getMembership(tupleId) + constantShift, elementPresences);
 	}
-      while (++fuzzyTupleIt != end);
-      // fuzzyTupleIt->getTuple() is necessarily a vector of zero (first fuzzy tuple that was read): no more tuple
+      // The last tuple is necessarily a vector of zero (first fuzzy tuple that was read): no more tuple
       // Comparing in the reverse order because the last ids are more likely to be different
-      while (!equal(tuple.rbegin(), tuple.rend(), fuzzyTupleIt->getTuple().rbegin()))
+      while (!equal(tuple.rbegin(), tuple.rend(), make_reverse_iterator(fuzzyTuples.getTuple(tupleId) + n)))
 	{
 	  *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, constantShift, elementPresences);
 	}
-      *shiftedMembershipIt = fuzzyTupleIt->getMembership() + constantShift;
+      *shiftedMembershipIt = fuzzyTuples.getMembership(tupleId) + constantShift;
       updateNullModelRSSAndElementMemberships(tuple, *shiftedMembershipIt, elementPresences);
       // PERF: instead of coying the integer presences into double memberships, it would be better to use elementPresences all along, turning several functions template
       const vector<vector<pair<unsigned int, unsigned int>>>::const_iterator elementPresencesEnd = elementPresences.end();
@@ -158,27 +158,26 @@ void DenseRoughTensor::init(vector<FuzzyTuple>& fuzzyTuples)
       while (++labelsInDimensionIt != labelsInDimensionEnd);
       shiftedMemberships.resize(nbOfTuples);
       vector<double>::reverse_iterator shiftedMembershipIt = shiftedMemberships.rbegin(); // filled backwards, so that in lexicographic order of the tuples
-      const vector<FuzzyTuple>::const_iterator end = --fuzzyTuples.end();
-      vector<FuzzyTuple>::const_iterator fuzzyTupleIt = fuzzyTuples.begin();
-      do
+      const size_t lastTupleId = fuzzyTuples.size() - 1;
+      size_t tupleId = 0;
+      for (; tupleId != lastTupleId; ++tupleId)
 	{
 	  // Comparing in the reverse order because the last ids are more likely to be different
-	  while (!equal(tuple.rbegin(), tuple.rend(), fuzzyTupleIt->getTuple().rbegin()))
+	  while (!equal(tuple.rbegin(), tuple.rend(), make_reverse_iterator(fuzzyTuples.getTuple(tupleId) + n)))
 	    {
 	      *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, -shift->getShift(tuple), elementPositiveMemberships, elementNegativeMemberships);
 	    }
 	  const double shiftForThisTuple = shift->getShift(tuple);
-	  ConcurrentPatternPool::addFuzzyTuple(tuple, fuzzyTupleIt->getMembership() - shiftForThisTuple);
-	  *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, fuzzyTupleIt->getMembership() - shiftForThisTuple, elementPositiveMemberships, elementNegativeMemberships);
+	  ConcurrentPatternPool::addFuzzyTuple(tuple.begin(), tuple.end(), fuzzyTuples.getMembership(tupleId) - shiftForThisTuple);
+	  *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, fuzzyTuples.getMembership(tupleId) - shiftForThisTuple, elementPositiveMemberships, elementNegativeMemberships);
 	}
-      while (++fuzzyTupleIt != end);
-      // fuzzyTupleIt->getTuple() is necessarily a vector of zero (first fuzzy tuple that was read): no more tuple
+      // The last tuple is necessarily a vector of zero (first fuzzy tuple that was read): no more tuple
       // Comparing in the reverse order because the last ids are more likely to be different
-      while (!equal(tuple.rbegin(), tuple.rend(), fuzzyTupleIt->getTuple().rbegin()))
+      while (!equal(tuple.rbegin(), tuple.rend(), make_reverse_iterator(fuzzyTuples.getTuple(tupleId) + n)))
 	{
 	  *shiftedMembershipIt++ = updateNullModelRSSAndElementMembershipsAndAdvance(tuple, -shift->getShift(tuple), elementPositiveMemberships, elementNegativeMemberships);
 	}
-      *shiftedMembershipIt = fuzzyTupleIt->getMembership() - shift->getShift(tuple);
+      *shiftedMembershipIt = fuzzyTuples.getMembership(tupleId) - shift->getShift(tuple);
       updateNullModelRSSAndElementMemberships(tuple, *shiftedMembershipIt, elementPositiveMemberships, elementNegativeMemberships);
       vector<vector<double>>::const_iterator elementNegativeMembershipsIt = elementNegativeMemberships.begin();
       minElementNegativeMembership = *min_element(elementNegativeMembershipsIt->begin(), elementNegativeMembershipsIt->end());
@@ -195,7 +194,6 @@ void DenseRoughTensor::init(vector<FuzzyTuple>& fuzzyTuples)
       while (++elementNegativeMembershipsIt != elementNegativeMembershipsEnd);
     }
   fuzzyTuples.clear();
-  fuzzyTuples.shrink_to_fit();
   // Compute new ids, in increasing order of element membership, set unit, cardinalities and external2InternalDimensionOrder
   setMetadata(elementPositiveMemberships, -minElementNegativeMembership);
   // Inform the shift of the new dimension order
@@ -19,7 +19,7 @@ class DenseRoughTensor final : public AbstractRoughTensor
  public:
   DenseRoughTensor(const DenseRoughTensor& otherDenseRoughTensor) = delete;
   DenseRoughTensor(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const bool isInput01, const bool isVerbose);
-  DenseRoughTensor(vector<FuzzyTuple>& fuzzyTuples, const double constantShift);
+  DenseRoughTensor(FuzzyTupleArray& fuzzyTuples, const double constantShift);
   ~DenseRoughTensor();
 
   DenseRoughTensor& operator=(const DenseRoughTensor& otherDenseRoughTensor) const = delete;
@@ -35,7 +35,7 @@ class DenseRoughTensor final : public AbstractRoughTensor
   vector<double> memberships; /* non-empty if only if patterns are to be selected */
   /* PERF: a specific class for a 0/1 tensor where memberships are stored in a dynamic_bitset */
 
-  void init(vector<FuzzyTuple>& fuzzyTuples);
+  void init(FuzzyTupleArray& fuzzyTuples);
   double updateNullModelRSSAndElementMembershipsAndAdvance(vector<unsigned int>& tuple, const double shiftedMembership, vector<vector<pair<unsigned int, unsigned int>>>& elementPresences);
   double updateNullModelRSSAndElementMembershipsAndAdvance(vector<unsigned int>& tuple, const double shiftedMembership, vector<vector<pair<double, unsigned int>>>& elementPositiveMemberships, vector<vector<double>>& elementNegativeMemberships);
   void updateNullModelRSSAndElementMemberships(const vector<unsigned int>& tuple, const double shiftedMembership, vector<vector<pair<unsigned int, unsigned int>>>& elementPresences);
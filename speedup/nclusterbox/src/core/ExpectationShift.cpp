@@ -38,7 +38,7 @@ vector<double> reorderElementAvgs(const vector<unsigned int>& newIds2OldIdsInDim
   return reorderedElementsAvgsInDimension;
 }
 
-ExpectationShift::ExpectationShift(const vector<FuzzyTuple>& fuzzyTuples, const vector<vector<string>>& ids2Labels): elementAvgs()
+ExpectationShift::ExpectationShift(const FuzzyTupleArray& fuzzyTuples, const vector<vector<string>>& ids2Labels): elementAvgs()
 {
   vector<vector<string>>::const_iterator ids2LabelsInDimensionIt = ids2Labels.begin();
   const vector<vector<string>>::const_iterator ids2LabelsInDimensionEnd = ids2Labels.end();
@@ -53,22 +53,23 @@ ExpectationShift::ExpectationShift(const vector<FuzzyTuple>& fuzzyTuples, const
     }
   while (++ids2LabelsInDimensionIt != ids2LabelsInDimensionEnd);
   ids2LabelsInDimensionIt = ids2Labels.begin();
-  const vector<FuzzyTuple>::const_iterator fuzzyTupleEnd = fuzzyTuples.end();
-  vector<FuzzyTuple>::const_iterator fuzzyTupleIt = fuzzyTuples.begin();
+  const size_t nbOfTuples = fuzzyTuples.size();
+  size_t tupleId = 0;
   do
     {
+      const double membership = fuzzyTuples.getMembership(tupleId);
       vector<vector<double>>::iterator elementAvgsInDimensionIt = elementAvgs.begin();
-      vector<unsigned int>::const_iterator elementIt = fuzzyTupleIt->getTuple().begin();
-      (*elementAvgsInDimensionIt)[*elementIt] += fuzzyTupleIt->getMembership();
+      vector<unsigned int>::const_iterator elementIt = fuzzyTuples.getTuple(tupleId);
+      (*elementAvgsInDimensionIt)[*elementIt] += membership;
       ++elementAvgsInDimensionIt;
       const vector<vector<double>>::iterator elementAvgsInDimensionEnd = elementAvgs.end();
       do
 	{
-	  (*elementAvgsInDimensionIt)[*++elementIt] += fuzzyTupleIt->getMembership();
+	  (*elementAvgsInDimensionIt)[*++elementIt] += membership;
 	}
       while (++elementAvgsInDimensionIt != elementAvgsInDimensionEnd);
     }
-  while (++fuzzyTupleIt != fuzzyTupleEnd);
+  while (++tupleId != nbOfTuples);
 
   unsigned int areaOfElementInDimension = area / ids2LabelsInDimensionIt->size();
   ++ids2LabelsInDimensionIt;
@@ -14,12 +14,12 @@
 #include <string>
 
 #include "AbstractShift.h"
-#include "FuzzyTuple.h"
+#include "FuzzyTupleArray.h"
 
 class ExpectationShift final : public AbstractShift
 {
  public:
-  ExpectationShift(const vector<FuzzyTuple>& fuzzyTuples, const vector<vector<string>>& ids2Labels);
+  ExpectationShift(const FuzzyTupleArray& fuzzyTuples, const vector<vector<string>>& ids2Labels);
 
   double getShift(const vector<unsigned int>& tuple) const;
   double getAverageShift(const vector<vector<unsigned int>>& nSet) const;
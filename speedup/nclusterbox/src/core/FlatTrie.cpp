@@ -0,0 +1,757 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "FlatTrie.h"
+
+#include <algorithm>
+
+#include "SparseCrispTube.h"
+#include "SparseFuzzyTube.h"
+#include "VectorizedSums.h"
+
+FlatTrie::FlatTrie(): cardinalities(), tubes(), arena(), sparseFuzzyTubeDefaultMembership(0)
+{
+}
+
+FlatTrie::FlatTrie(Trie&& trie, const vector<unsigned int>& cardinalitiesParam): cardinalities(cardinalitiesParam), tubes(), arena(), sparseFuzzyTubeDefaultMembership(SparseFuzzyTube::getDefaultMembership())
+{
+  size_t nbOfTubes = 1;
+  for (vector<unsigned int>::const_iterator cardinalityIt = cardinalities.begin(), lastCardinalityIt = --cardinalities.end(); cardinalityIt != lastCardinalityIt; ++cardinalityIt)
+    {
+      nbOfTubes *= *cardinalityIt;
+    }
+  tubes.reserve(nbOfTubes + 1);
+  trie.flatten(*this);
+  tubes.push_back(arena.size() << 2);
+  arena.shrink_to_fit();
+}
+
+void FlatTrie::clearAndFree()
+{
+  tubes.clear();
+  tubes.shrink_to_fit();
+  arena.clear();
+  arena.shrink_to_fit();
+}
+
+void FlatTrie::addSparseCrispTube(const vector<unsigned int>& tube)
+{
+  tubes.push_back(arena.size() << 2 | sparseCrisp);
+  arena.insert(arena.end(), tube.begin(), tube.end());
+}
+
+void FlatTrie::addDenseCrispTube(const vector<unsigned long long>& tube)
+{
+  tubes.push_back(arena.size() << 2 | denseCrisp);
+  const unsigned int nbOfWords = (cardinalities.back() + 31) / 32;
+  for (unsigned int wordId = 0; wordId != nbOfWords; ++wordId)
+    {
+      arena.push_back(tube[wordId / 2] >> wordId % 2 * 32);
+    }
+}
+
+void FlatTrie::addSparseFuzzyTube(const vector<pair<unsigned int, int>>& tube)
+{
+  tubes.push_back(arena.size() << 2 | sparseFuzzy);
+  for (const pair<unsigned int, int>& entry : tube)
+    {
+      arena.push_back(entry.first);
+    }
+  for (const pair<unsigned int, int>& entry : tube)
+    {
+      arena.push_back(entry.second);
+    }
+}
+
+void FlatTrie::addDenseFuzzyTube(const vector<int>& tube)
+{
+  tubes.push_back(arena.size() << 2 | denseFuzzy);
+  arena.insert(arena.end(), tube.begin(), tube.end());
+}
+
+long long FlatTrie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const
+{
+  const vector<vector<int>>::iterator sumsEnd = sumsOnHyperplanes.end();
+  vector<vector<int>>::iterator sumsIt = sumsOnHyperplanes.begin();
+  do
+    {
+      fill(sumsIt->begin(), sumsIt->end(), 0);
+    }
+  while (++sumsIt != sumsEnd);
+  sumsIt = sumsOnHyperplanes.begin();
+  vector<int>::iterator sumIt = sumsIt->begin();
+  ++sumsIt;
+  long long sumOnPattern = 0;
+  const vector<unsigned int>::const_iterator nextCardinalityIt = ++cardinalities.begin();
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = nSetBegin + 1;
+  size_t childId = 0;
+  {
+    // Hyperplanes until the last present one
+    const vector<unsigned int>::const_iterator presentElementIdEnd = nSetBegin->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = nSetBegin->begin();
+    do
+      {
+	for (; childId != *presentElementIdIt; ++childId)
+	  {
+	    this->sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	const int sum = sumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, sumsIt);
+	sumOnPattern += sum;
+	*sumIt++ += sum;
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = cardinalities.front(); childId != childEnd; ++childId)
+    {
+      this->sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+  return sumOnPattern;
+}
+
+long long FlatTrie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes, const unsigned long long area, const int unit) const
+{
+  // is01
+  const long long sumOnPattern = sumsOnPatternAndHyperplanes(nSetBegin, sumsOnHyperplanes) * unit + SparseCrispTube::getDefaultMembership() * area;
+  const vector<vector<int>>::iterator sumsEnd = sumsOnHyperplanes.end();
+  vector<vector<int>>::iterator sumsIt = sumsOnHyperplanes.begin();
+  vector<vector<unsigned int>>::const_iterator dimensionIt = nSetBegin;
+  do
+    {
+      const int shift = SparseCrispTube::getDefaultMembership() * static_cast<long long>(area / dimensionIt->size());
+      const vector<int>::iterator sumEnd = sumsIt->end();
+      vector<int>::iterator sumIt = sumsIt->begin();
+      do
+	{
+	  *sumIt *= unit;
+	  *sumIt += shift;
+	}
+      while (++sumIt != sumEnd);
+      ++dimensionIt;
+    }
+  while (++sumsIt != sumsEnd);
+  return sumOnPattern;
+}
+
+void FlatTrie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = ++cardinalities.begin();
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionBegin + 1;
+  if (increasedDimensionId)
+    {
+      vector<int>& unchangedSums = sums[increasedDimensionId];
+      vector<int> empty;
+      empty.swap(unchangedSums);
+      vector<int>::iterator sumIt = sums.front().begin();
+      size_t childId = 0;
+      {
+	// Hyperplanes until the last present one
+	const vector<vector<int>>::iterator nextSumsIt = ++sums.begin();
+	const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionBegin->end();
+	vector<unsigned int>::const_iterator presentElementIdIt = dimensionBegin->begin();
+	do
+	  {
+	    for (; childId != *presentElementIdIt; ++childId)
+	      {
+		sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+		++sumIt;
+	      }
+	    *sumIt++ += increaseSumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+	  }
+	while (++presentElementIdIt != presentElementIdEnd);
+      }
+      // Hyperplanes after the last present one
+      for (const size_t childEnd = cardinalities.front(); childId != childEnd; ++childId)
+	{
+	  sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	  ++sumIt;
+	}
+      empty.swap(unchangedSums);
+      return;
+    }
+  increaseSumsOnHyperplanes(dimensionBegin->front(), nextCardinalityIt, nextDimensionIt, ++sums.begin());
+}
+
+void FlatTrie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums, const int area, const int unit) const
+{
+  // is01
+  static thread_local vector<vector<int>> increases; // reused from one call to the next, not to allocate memory at every step
+  increases.resize(sums.size());
+  vector<vector<int>>::iterator sumsIt = sums.begin();
+  for (vector<int>& increasesInDimension : increases)
+    {
+      increasesInDimension.assign(sumsIt->size(), 0);
+      ++sumsIt;
+    }
+  increases[increasedDimensionId].clear();
+  increaseSumsOnHyperplanes(dimensionBegin, increasedDimensionId, increases);
+  sumsIt = sums.begin();
+  const int defaultNSetMembership = SparseCrispTube::getDefaultMembership() * area;
+  vector<vector<unsigned int>>::const_iterator dimensionIt = dimensionBegin;
+  vector<vector<int>>::const_iterator increasesIt = increases.begin();
+  for (; !increasesIt->empty(); ++increasesIt)
+    {
+      const int shift = defaultNSetMembership / static_cast<int>(dimensionIt->size());
+      vector<int>::iterator sumIt = sumsIt->begin();
+      for (const int increase : *increasesIt)
+	{
+	  *sumIt++ += increase * unit + shift;
+	}
+      ++sumsIt;
+      ++dimensionIt;
+    }
+  for (const vector<vector<int>>::const_iterator increasesEnd = increases.end(); ++increasesIt != increasesEnd; )
+    {
+      const int shift = defaultNSetMembership / static_cast<int>((++dimensionIt)->size());
+      vector<int>::iterator sumIt = (++sumsIt)->begin();
+      for (const int increase : *increasesIt)
+	{
+	  *sumIt++ += increase * unit + shift;
+	}
+    }
+}
+
+void FlatTrie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int decreasedDimensionId, vector<vector<int>>& sums) const
+{
+  // !is01
+  const vector<unsigned int>::const_iterator nextCardinalityIt = ++cardinalities.begin();
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionBegin + 1;
+  if (decreasedDimensionId)
+    {
+      vector<int>& unchangedSums = sums[decreasedDimensionId];
+      vector<int> empty;
+      empty.swap(unchangedSums);
+      vector<int>::iterator sumIt = sums.front().begin();
+      size_t childId = 0;
+      {
+	// Hyperplanes until the last present one
+	const vector<vector<int>>::iterator nextSumsIt = ++sums.begin();
+	const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionBegin->end();
+	vector<unsigned int>::const_iterator presentElementIdIt = dimensionBegin->begin();
+	do
+	  {
+	    for (; childId != *presentElementIdIt; ++childId)
+	      {
+		minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+		++sumIt;
+	      }
+	    *sumIt++ -= decreaseSumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+	  }
+	while (++presentElementIdIt != presentElementIdEnd);
+      }
+      // Hyperplanes after the last present one
+      for (const size_t childEnd = cardinalities.front(); childId != childEnd; ++childId)
+	{
+	  minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	  ++sumIt;
+	}
+      empty.swap(unchangedSums);
+      return;
+    }
+  decreaseSumsOnHyperplanes(dimensionBegin->front(), nextCardinalityIt, nextDimensionIt, ++sums.begin());
+}
+
+void FlatTrie::sumOnPattern(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      sumOnTube(nodeId, *dimensionIt, sum);
+      return;
+    }
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  for (const unsigned int id : *dimensionIt)
+    {
+      sumOnPattern(firstChildId + id, nextCardinalityIt, nextDimensionIt, sum);
+    }
+}
+
+void FlatTrie::minusSumOnPattern(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      minusSumOnTube(nodeId, *dimensionIt, sum);
+      return;
+    }
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  for (const unsigned int id : *dimensionIt)
+    {
+      minusSumOnPattern(firstChildId + id, nextCardinalityIt, nextDimensionIt, sum);
+    }
+}
+
+int FlatTrie::sumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      addTube(nodeId, *sumsIt);
+      int sumOnPattern = 0;
+      sumOnTube(nodeId, *dimensionIt, sumOnPattern);
+      return sumOnPattern;
+    }
+  int sumOnPattern = 0;
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  vector<int>::iterator sumIt = sumsIt->begin();
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  size_t childId = firstChildId;
+  {
+    // Hyperplanes until the last present one
+    const vector<vector<int>>::iterator nextSumsIt = sumsIt + 1;
+    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
+    do
+      {
+	for (const size_t end = firstChildId + *presentElementIdIt; childId != end; ++childId)
+	  {
+	    this->sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	const int sum = sumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+	sumOnPattern += sum;
+	*sumIt++ += sum;
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = firstChildId + *cardinalityIt; childId != childEnd; ++childId)
+    {
+      this->sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+  return sumOnPattern;
+}
+
+int FlatTrie::minusSumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      subtractTube(nodeId, *sumsIt);
+      int sumOnPattern = 0;
+      sumOnTube(nodeId, *dimensionIt, sumOnPattern);
+      return sumOnPattern;
+    }
+  int sumOnPattern = 0;
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  vector<int>::iterator sumIt = sumsIt->begin();
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  size_t childId = firstChildId;
+  {
+    // Hyperplanes until the last present one
+    const vector<vector<int>>::iterator nextSumsIt = sumsIt + 1;
+    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
+    do
+      {
+	for (const size_t end = firstChildId + *presentElementIdIt; childId != end; ++childId)
+	  {
+	    minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	const int sum = minusSumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+	*sumIt++ -= sum;
+	sumOnPattern += sum;
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = firstChildId + *cardinalityIt; childId != childEnd; ++childId)
+    {
+      minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+  return sumOnPattern;
+}
+
+void FlatTrie::increaseSumsOnHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  // sumsOnPatternAndHyperplanes without computing the sumOnPattern
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      // n == 2 and first dimension increased
+      addTube(nodeId, *sumsIt);
+      return;
+    }
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  vector<int>::iterator sumIt = sumsIt->begin();
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  size_t childId = firstChildId;
+  {
+    // Hyperplanes until the last present one
+    const vector<vector<int>>::iterator nextSumsIt = sumsIt + 1;
+    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
+    do
+      {
+	for (const size_t end = firstChildId + *presentElementIdIt; childId != end; ++childId)
+	  {
+	    sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	*sumIt++ += sumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = firstChildId + *cardinalityIt; childId != childEnd; ++childId)
+    {
+      sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+}
+
+void FlatTrie::decreaseSumsOnHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  // minusSumsOnPatternAndHyperplanes without computing the sumOnPattern
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      // n == 2 and first dimension decreased
+      subtractTube(nodeId, *sumsIt);
+      return;
+    }
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  vector<int>::iterator sumIt = sumsIt->begin();
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  size_t childId = firstChildId;
+  {
+    // Hyperplanes until the last present one
+    const vector<vector<int>>::iterator nextSumsIt = sumsIt + 1;
+    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
+    do
+      {
+	for (const size_t end = firstChildId + *presentElementIdIt; childId != end; ++childId)
+	  {
+	    minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	*sumIt++ -= minusSumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = firstChildId + *cardinalityIt; childId != childEnd; ++childId)
+    {
+      minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+}
+
+int FlatTrie::increaseSumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      // necessarily the increased dimension
+      return membershipInTube(nodeId, dimensionIt->front());
+    }
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  if (sumsIt->empty())
+    {
+      return sumsOnPatternAndHyperplanes(firstChildId + dimensionIt->front(), nextCardinalityIt, nextDimensionIt, sumsIt + 1);
+    }
+  int sumOnPattern = 0;
+  vector<int>::iterator sumIt = sumsIt->begin();
+  size_t childId = firstChildId;
+  {
+    // Hyperplanes until the last present one
+    const vector<vector<int>>::iterator nextSumsIt = sumsIt + 1;
+    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
+    do
+      {
+	for (const size_t end = firstChildId + *presentElementIdIt; childId != end; ++childId)
+	  {
+	    this->sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	const int sum = increaseSumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+	*sumIt++ += sum;
+	sumOnPattern += sum;
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = firstChildId + *cardinalityIt; childId != childEnd; ++childId)
+    {
+      this->sumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+  return sumOnPattern;
+}
+
+int FlatTrie::decreaseSumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
+  if (nextCardinalityIt == cardinalities.end())
+    {
+      // fuzzy tube and necessarily the decreased dimension
+      return membershipInTube(nodeId, dimensionIt->front());
+    }
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  const size_t firstChildId = nodeId * *cardinalityIt;
+  if (sumsIt->empty())
+    {
+      return minusSumsOnPatternAndHyperplanes(firstChildId + dimensionIt->front(), nextCardinalityIt, nextDimensionIt, sumsIt + 1);
+    }
+  int sumOnPattern = 0;
+  vector<int>::iterator sumIt = sumsIt->begin();
+  size_t childId = firstChildId;
+  {
+    // Hyperplanes until the last present one
+    const vector<vector<int>>::iterator nextSumsIt = sumsIt + 1;
+    const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end();
+    vector<unsigned int>::const_iterator presentElementIdIt = dimensionIt->begin();
+    do
+      {
+	for (const size_t end = firstChildId + *presentElementIdIt; childId != end; ++childId)
+	  {
+	    minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+	    ++sumIt;
+	  }
+	const int sum = decreaseSumsOnPatternAndHyperplanes(childId++, nextCardinalityIt, nextDimensionIt, nextSumsIt);
+	*sumIt++ -= sum;
+	sumOnPattern += sum;
+      }
+    while (++presentElementIdIt != presentElementIdEnd);
+  }
+  // Hyperplanes after the last present one
+  for (const size_t childEnd = firstChildId + *cardinalityIt; childId != childEnd; ++childId)
+    {
+      minusSumOnPattern(childId, nextCardinalityIt, nextDimensionIt, *sumIt);
+      ++sumIt;
+    }
+  return sumOnPattern;
+}
+
+void FlatTrie::sumOnTube(const size_t tubeId, const vector<unsigned int>& ids, int& sum) const
+{
+  const unsigned long long tube = tubes[tubeId];
+  const unsigned int* const tubeBegin = arena.data() + (tube >> 2);
+  const vector<unsigned int>::const_iterator idEnd = ids.end();
+  vector<unsigned int>::const_iterator idIt = ids.begin();
+  switch (tube & 3)
+    {
+    case sparseCrisp:
+      {
+	const unsigned int* const tubeEnd = arena.data() + (tubes[tubeId + 1] >> 2);
+	const unsigned int* idInTubeIt = tubeBegin;
+	do
+	  {
+	    idInTubeIt = lower_bound(idInTubeIt, tubeEnd, *idIt);
+	    if (idInTubeIt == tubeEnd)
+	      {
+		return;
+	      }
+	    if (*idInTubeIt == *idIt)
+	      {
+		++sum;
+	      }
+	  }
+	while (++idIt != idEnd);
+	return;
+      }
+    case denseCrisp:
+      do
+	{
+	  sum += tubeBegin[*idIt / 32] >> *idIt % 32 & 1;
+	}
+      while (++idIt != idEnd);
+      return;
+    case sparseFuzzy:
+      {
+	const unsigned int* const idInTubeEnd = tubeBegin + ((tubes[tubeId + 1] >> 2) - (tube >> 2)) / 2;
+	const ptrdiff_t nbOfEntries = idInTubeEnd - tubeBegin;
+	const unsigned int* idInTubeIt = tubeBegin;
+	int nbOfDefaultMemberships = 0;
+	do
+	  {
+	    idInTubeIt = lower_bound(idInTubeIt, idInTubeEnd, *idIt);
+	    if (idInTubeIt == idInTubeEnd)
+	      {
+		sum += static_cast<int>(idEnd - idIt + nbOfDefaultMemberships) * sparseFuzzyTubeDefaultMembership;
+		return;
+	      }
+	    if (*idInTubeIt == *idIt)
+	      {
+		sum += static_cast<int>(idInTubeIt[nbOfEntries]);
+	      }
+	    else
+	      {
+		++nbOfDefaultMemberships;
+	      }
+	  }
+	while (++idIt != idEnd);
+	sum += nbOfDefaultMemberships * sparseFuzzyTubeDefaultMembership;
+	return;
+      }
+    default:
+      // denseFuzzy
+      do
+	{
+	  sum += static_cast<int>(tubeBegin[*idIt]);
+	}
+      while (++idIt != idEnd);
+    }
+}
+
+void FlatTrie::minusSumOnTube(const size_t tubeId, const vector<unsigned int>& ids, int& sum) const
+{
+  // fuzzy tube
+  const unsigned long long tube = tubes[tubeId];
+  const unsigned int* const tubeBegin = arena.data() + (tube >> 2);
+  const vector<unsigned int>::const_iterator idEnd = ids.end();
+  vector<unsigned int>::const_iterator idIt = ids.begin();
+  if ((tube & 3) == sparseFuzzy)
+    {
+      const unsigned int* const idInTubeEnd = tubeBegin + ((tubes[tubeId + 1] >> 2) - (tube >> 2)) / 2;
+      const ptrdiff_t nbOfEntries = idInTubeEnd - tubeBegin;
+      const unsigned int* idInTubeIt = tubeBegin;
+      int nbOfDefaultMemberships = 0;
+      do
+	{
+	  idInTubeIt = lower_bound(idInTubeIt, idInTubeEnd, *idIt);
+	  if (idInTubeIt == idInTubeEnd)
+	    {
+	      sum -= static_cast<int>(idEnd - idIt + nbOfDefaultMemberships) * sparseFuzzyTubeDefaultMembership;
+	      return;
+	    }
+	  if (*idInTubeIt == *idIt)
+	    {
+	      sum -= static_cast<int>(idInTubeIt[nbOfEntries]);
+	    }
+	  else
+	    {
+	      ++nbOfDefaultMemberships;
+	    }
+	}
+      while (++idIt != idEnd);
+      sum -= nbOfDefaultMemberships * sparseFuzzyTubeDefaultMembership;
+      return;
+    }
+  do
+    {
+      sum -= static_cast<int>(tubeBegin[*idIt]);
+    }
+  while (++idIt != idEnd);
+}
+
+int FlatTrie::membershipInTube(const size_t tubeId, const unsigned int id) const
+{
+  const unsigned long long tube = tubes[tubeId];
+  const unsigned int* const tubeBegin = arena.data() + (tube >> 2);
+  switch (tube & 3)
+    {
+    case sparseCrisp:
+      return binary_search(tubeBegin, arena.data() + (tubes[tubeId + 1] >> 2), id);
+    case denseCrisp:
+      return tubeBegin[id / 32] >> id % 32 & 1;
+    case sparseFuzzy:
+      {
+	const unsigned int* const idInTubeEnd = tubeBegin + ((tubes[tubeId + 1] >> 2) - (tube >> 2)) / 2;
+	const unsigned int* const idInTubeIt = lower_bound(tubeBegin, idInTubeEnd, id);
+	if (idInTubeIt == idInTubeEnd || *idInTubeIt != id)
+	  {
+	    return sparseFuzzyTubeDefaultMembership;
+	  }
+	return static_cast<int>(idInTubeIt[idInTubeEnd - tubeBegin]);
+      }
+    default:
+      // denseFuzzy
+      return static_cast<int>(tubeBegin[id]);
+    }
+}
+
+void FlatTrie::addTube(const size_t tubeId, vector<int>& sums) const
+{
+  const unsigned long long tube = tubes[tubeId];
+  const unsigned int* const tubeBegin = arena.data() + (tube >> 2);
+  const unsigned int* const tubeEnd = arena.data() + (tubes[tubeId + 1] >> 2);
+  switch (tube & 3)
+    {
+    case sparseCrisp:
+      for (const unsigned int* idInTubeIt = tubeBegin; idInTubeIt != tubeEnd; ++idInTubeIt)
+	{
+	  ++sums[*idInTubeIt];
+	}
+      return;
+    case denseCrisp:
+      for (const unsigned int* wordIt = tubeBegin; wordIt != tubeEnd; ++wordIt)
+	{
+	  const vector<int>::iterator sumBegin = sums.begin() + 32 * (wordIt - tubeBegin);
+	  for (unsigned int word = *wordIt; word; word &= word - 1)
+	    {
+	      ++sumBegin[__builtin_ctz(word)];
+	    }
+	}
+      return;
+    case sparseFuzzy:
+      {
+	const unsigned int* const idInTubeEnd = tubeBegin + (tubeEnd - tubeBegin) / 2;
+	const ptrdiff_t nbOfEntries = idInTubeEnd - tubeBegin;
+	const vector<int>::iterator sumBegin = sums.begin();
+	vector<int>::iterator sumIt = sumBegin;
+	for (const unsigned int* idInTubeIt = tubeBegin; idInTubeIt != idInTubeEnd; ++idInTubeIt)
+	  {
+	    for (const vector<int>::iterator end = sumBegin + *idInTubeIt; sumIt != end; ++sumIt)
+	      {
+		*sumIt += sparseFuzzyTubeDefaultMembership;
+	      }
+	    *sumIt++ += static_cast<int>(idInTubeIt[nbOfEntries]);
+	  }
+	for (const vector<int>::iterator sumEnd = sums.end(); sumIt != sumEnd; ++sumIt)
+	  {
+	    *sumIt += sparseFuzzyTubeDefaultMembership;
+	  }
+	return;
+      }
+    default:
+      // denseFuzzy
+      VectorizedSums::add(reinterpret_cast<const int*>(tubeBegin), tubeEnd - tubeBegin, sums.data());
+    }
+}
+
+void FlatTrie::subtractTube(const size_t tubeId, vector<int>& sums) const
+{
+  // fuzzy tube
+  const unsigned long long tube = tubes[tubeId];
+  const unsigned int* const tubeBegin = arena.data() + (tube >> 2);
+  const unsigned int* const tubeEnd = arena.data() + (tubes[tubeId + 1] >> 2);
+  if ((tube & 3) == sparseFuzzy)
+    {
+      const unsigned int* const idInTubeEnd = tubeBegin + (tubeEnd - tubeBegin) / 2;
+      const ptrdiff_t nbOfEntries = idInTubeEnd - tubeBegin;
+      const vector<int>::iterator sumBegin = sums.begin();
+      vector<int>::iterator sumIt = sumBegin;
+      for (const unsigned int* idInTubeIt = tubeBegin; idInTubeIt != idInTubeEnd; ++idInTubeIt)
+	{
+	  for (const vector<int>::iterator end = sumBegin + *idInTubeIt; sumIt != end; ++sumIt)
+	    {
+	      *sumIt -= sparseFuzzyTubeDefaultMembership;
+	    }
+	  *sumIt++ -= static_cast<int>(idInTubeIt[nbOfEntries]);
+	}
+      for (const vector<int>::iterator sumEnd = sums.end(); sumIt != sumEnd; ++sumIt)
+	{
+	  *sumIt -= sparseFuzzyTubeDefaultMembership;
+	}
+      return;
+    }
+  VectorizedSums::subtract(reinterpret_cast<const int*>(tubeBegin), tubeEnd - tubeBegin, sums.data());
+}
@@ -0,0 +1,61 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef FLAT_TRIE_H_
+#define FLAT_TRIE_H_
+
+#include "Trie.h"
+
+/* Same tensor and same computations as Trie, but without any pointer: the tubes are stored one after the other, in lexicographic order, in one single arena, and the internal nodes, which a complete trie does not need to store, are implicit: the children of the node at index i in its level are at indexes i * cardinality to i * cardinality + cardinality - 1 in the next level */
+class FlatTrie
+{
+ public:
+  FlatTrie();
+  FlatTrie(Trie&& trie, const vector<unsigned int>& cardinalities); /* trie is emptied while flattened */
+
+  void clearAndFree();
+
+  void addSparseCrispTube(const vector<unsigned int>& tube);
+  void addDenseCrispTube(const vector<unsigned long long>& tube);
+  void addSparseFuzzyTube(const vector<pair<unsigned int, int>>& tube);
+  void addDenseFuzzyTube(const vector<int>& tube);
+
+  long long sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const;
+  long long sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes, const unsigned long long area, const int unit) const;
+  void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums) const;
+  void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums, const int area, const int unit) const;
+  void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int decreasedDimensionId, vector<vector<int>>& sums) const;
+
+ private:
+  enum TubeKind { sparseCrisp, denseCrisp, sparseFuzzy, denseFuzzy };
+
+  vector<unsigned int> cardinalities;
+  vector<unsigned long long> tubes; /* every value is the offset of a tube in arena, shifted by two bits, plus its TubeKind; the last value is the end offset of the last tube */
+  vector<unsigned int> arena;	    /* a sparse crisp tube is a sorted list of ids, a dense crisp tube a list of 32-bit words, a sparse fuzzy tube a sorted list of ids followed by the related memberships and a dense fuzzy tube a list of memberships */
+  int sparseFuzzyTubeDefaultMembership;
+
+  // A node at the last level (cardinalityIt + 1 == cardinalities.end()) is a tube
+  void sumOnPattern(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
+  void minusSumOnPattern(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
+  int sumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  int minusSumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  void increaseSumsOnHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  void decreaseSumsOnHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  int increaseSumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  int decreaseSumsOnPatternAndHyperplanes(const size_t nodeId, const vector<unsigned int>::const_iterator cardinalityIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+
+  void sumOnTube(const size_t tubeId, const vector<unsigned int>& ids, int& sum) const;
+  void minusSumOnTube(const size_t tubeId, const vector<unsigned int>& ids, int& sum) const;
+  int membershipInTube(const size_t tubeId, const unsigned int id) const;
+  void addTube(const size_t tubeId, vector<int>& sums) const;
+  void subtractTube(const size_t tubeId, vector<int>& sums) const;
+};
+
+#endif /*FLAT_TRIE_H_*/
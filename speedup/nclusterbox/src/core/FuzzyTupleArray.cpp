@@ -0,0 +1,383 @@
+// Copyright 2018-2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "FuzzyTupleArray.h"
+
+#include <limits>
+#include <thread>
+#include <algorithm>
+
+FuzzyTupleArray::FuzzyTupleArray(): FuzzyTupleArray(0)
+{
+}
+
+FuzzyTupleArray::FuzzyTupleArray(const unsigned int nParam): n(nParam), ids(), memberships(), constantMembership(1)
+{
+}
+
+unsigned int FuzzyTupleArray::getN() const
+{
+  return n;
+}
+
+size_t FuzzyTupleArray::size() const
+{
+  if (n)
+    {
+      return ids.size() / n;
+    }
+  return 0;
+}
+
+bool FuzzyTupleArray::empty() const
+{
+  return ids.empty();
+}
+
+vector<unsigned int>::const_iterator FuzzyTupleArray::getTuple(const size_t tupleId) const
+{
+  return ids.begin() + tupleId * n;
+}
+
+unsigned int FuzzyTupleArray::getElementId(const size_t tupleId, const unsigned int dimensionId) const
+{
+  return ids[tupleId * n + dimensionId];
+}
+
+double FuzzyTupleArray::getMembership(const size_t tupleId) const
+{
+  if (memberships.empty())
+    {
+      return constantMembership;
+    }
+  return memberships[tupleId];
+}
+
+double FuzzyTupleArray::getMembershipSquared(const size_t tupleId) const
+{
+  const double membership = getMembership(tupleId);
+  return membership * membership;
+}
+
+const vector<unsigned int>& FuzzyTupleArray::getIds() const
+{
+  return ids;
+}
+
+const vector<double>& FuzzyTupleArray::getMemberships() const
+{
+  return memberships;
+}
+
+void FuzzyTupleArray::reserve(const size_t nbOfTuples)
+{
+  ids.reserve(nbOfTuples * n);
+}
+
+void FuzzyTupleArray::clear()
+{
+  vector<unsigned int>().swap(ids);
+  vector<double>().swap(memberships);
+}
+
+void FuzzyTupleArray::push_back(const vector<vector<unsigned int>::const_iterator>& tupleIts)
+{
+  for (const vector<unsigned int>::const_iterator tupleIt : tupleIts)
+    {
+      ids.push_back(*tupleIt);
+    }
+}
+
+void FuzzyTupleArray::push_back(const vector<vector<unsigned int>::const_iterator>& tupleIts, const double membership)
+{
+  push_back(tupleIts);
+  memberships.push_back(membership);
+}
+
+void FuzzyTupleArray::assign(const unsigned int* idBegin, const size_t nbOfTuples, const double* membershipBegin)
+{
+  ids.assign(idBegin, idBegin + nbOfTuples * n);
+  if (membershipBegin)
+    {
+      memberships.assign(membershipBegin, membershipBegin + nbOfTuples);
+      return;
+    }
+  vector<double>().swap(memberships);
+  constantMembership = 1;
+}
+
+void FuzzyTupleArray::append(FuzzyTupleArray& otherFuzzyTupleArray)
+{
+  if (ids.empty())
+    {
+      ids.swap(otherFuzzyTupleArray.ids);
+      memberships.swap(otherFuzzyTupleArray.memberships);
+      constantMembership = otherFuzzyTupleArray.constantMembership;
+      otherFuzzyTupleArray.clear();
+      return;
+    }
+  ids.insert(ids.end(), otherFuzzyTupleArray.ids.begin(), otherFuzzyTupleArray.ids.end());
+  memberships.insert(memberships.end(), otherFuzzyTupleArray.memberships.begin(), otherFuzzyTupleArray.memberships.end());
+  otherFuzzyTupleArray.clear();
+}
+
+void FuzzyTupleArray::sortAndRemoveDuplicates(const vector<vector<string>>& ids2Labels)
+{
+  const size_t nbOfTuples = size();
+  if (nbOfTuples < 2)
+    {
+      return;
+    }
+  const unsigned int nbOfThreads = min(static_cast<size_t>(max(thread::hardware_concurrency(), 1U)), (nbOfTuples >> 16) + 1);
+  if (nbOfTuples <= numeric_limits<unsigned int>::max())
+    {
+      gatherWithoutDuplicates(radixSortedTupleIds<unsigned int>(ids2Labels, nbOfThreads), nbOfThreads);
+      return;
+    }
+  gatherWithoutDuplicates(radixSortedTupleIds<size_t>(ids2Labels, nbOfThreads), nbOfThreads);
+}
+
+void FuzzyTupleArray::shiftMemberships(const double shift)
+{
+  if (memberships.empty())
+    {
+      constantMembership -= shift;
+      return;
+    }
+  for (double& membership : memberships)
+    {
+      membership -= shift;
+    }
+}
+
+void FuzzyTupleArray::reorder(const vector<unsigned int>& oldOrder2NewOrder)
+{
+  vector<unsigned int> newTuple(n);
+  const vector<unsigned int>::iterator idEnd = ids.end();
+  for (vector<unsigned int>::iterator idIt = ids.begin(); idIt != idEnd; )
+    {
+      const vector<unsigned int>::iterator tupleBegin = idIt;
+      for (const unsigned int newDimensionId : oldOrder2NewOrder)
+	{
+	  newTuple[newDimensionId] = *idIt++;
+	}
+      copy(newTuple.begin(), newTuple.end(), tupleBegin);
+    }
+}
+
+void FuzzyTupleArray::setNewIds(const unsigned int dimensionId, const vector<unsigned int>& oldIds2NewIdsInDimension)
+{
+  const size_t idEnd = ids.size();
+  for (size_t idId = dimensionId; idId < idEnd; idId += n)
+    {
+      ids[idId] = oldIds2NewIdsInDimension[ids[idId]];
+    }
+}
+
+void FuzzyTupleArray::setNewIds(const vector<vector<unsigned int>>& oldIds2NewIds)
+{
+  const size_t nbOfTuples = size();
+  size_t nbOfKeptTuples = 0;
+  for (size_t tupleId = 0; tupleId != nbOfTuples; ++tupleId)
+    {
+      const vector<unsigned int>::const_iterator tuple = ids.begin() + tupleId * n;
+      const vector<unsigned int>::iterator newTuple = ids.begin() + nbOfKeptTuples * n;
+      unsigned int dimensionId = 0;
+      for (; dimensionId != n; ++dimensionId)
+	{
+	  const unsigned int newId = oldIds2NewIds[dimensionId][tuple[dimensionId]];
+	  if (newId == numeric_limits<unsigned int>::max())
+	    {
+	      break;
+	    }
+	  newTuple[dimensionId] = newId;
+	}
+      if (dimensionId == n)
+	{
+	  if (!memberships.empty())
+	    {
+	      memberships[nbOfKeptTuples] = memberships[tupleId];
+	    }
+	  ++nbOfKeptTuples;
+	}
+    }
+  ids.resize(nbOfKeptTuples * n);
+  if (!memberships.empty())
+    {
+      memberships.resize(nbOfKeptTuples);
+    }
+}
+
+void FuzzyTupleArray::inParallel(const unsigned int nbOfThreads, const size_t nbOfItems, const function<void(const unsigned int, const size_t, const size_t)>& process)
+{
+  vector<thread> threads;
+  threads.reserve(nbOfThreads - 1);
+  for (unsigned int threadId = 1; threadId != nbOfThreads; ++threadId)
+    {
+      threads.emplace_back(process, threadId, nbOfItems * threadId / nbOfThreads, nbOfItems * (threadId + 1) / nbOfThreads);
+    }
+  process(0, 0, nbOfItems / nbOfThreads);
+  for (thread& t : threads)
+    {
+      t.join();
+    }
+}
+
+template<typename T> vector<T> FuzzyTupleArray::radixSortedTupleIds(const vector<vector<string>>& ids2Labels, const unsigned int nbOfThreads) const
+{
+  // Group consecutive dimensions into 64-bit words, a word encoding the ids of its dimensions in mixed radix, complemented so that increasing words mean decreasing tuples
+  vector<unsigned int> complementedIdBases;
+  complementedIdBases.reserve(n);
+  vector<unsigned int> nbsOfBits;
+  nbsOfBits.reserve(n);
+  vector<pair<unsigned int, unsigned int>> words; // first dimension and number of bits of every word
+  for (const vector<string>& ids2LabelsInDimension : ids2Labels)
+    {
+      const unsigned int maxId = ids2LabelsInDimension.size() - 1;
+      complementedIdBases.push_back(maxId);
+      const unsigned int nbOfBits = maxId ? 32 - __builtin_clz(maxId) : 0;
+      nbsOfBits.push_back(nbOfBits);
+      if (words.empty() || words.back().second + nbOfBits > 64)
+	{
+	  words.emplace_back(nbsOfBits.size() - 1, nbOfBits);
+	}
+      else
+	{
+	  words.back().second += nbOfBits;
+	}
+    }
+  // Least significant digit radix sort of the tuple ids, word by word from the last one
+  const size_t nbOfTuples = size();
+  vector<T> tupleIds(nbOfTuples);
+  vector<T> otherTupleIds(nbOfTuples);
+  vector<unsigned long long> keys(nbOfTuples);
+  vector<unsigned long long> otherKeys(nbOfTuples);
+  vector<vector<size_t>> digitCounts(nbOfThreads, vector<size_t>(256));
+  bool isFirstWord = true;
+  for (vector<pair<unsigned int, unsigned int>>::const_reverse_iterator wordIt = words.rbegin(); wordIt != words.rend(); ++wordIt)
+    {
+      const unsigned int firstDimensionId = wordIt->first;
+      const unsigned int endDimensionId = wordIt == words.rbegin() ? n : (wordIt - 1)->first;
+      const unsigned int nbOfBitsInWord = wordIt->second;
+      inParallel(nbOfThreads, nbOfTuples, [&](const unsigned int threadId, const size_t begin, const size_t end)
+		 {
+		   for (size_t position = begin; position != end; ++position)
+		     {
+		       if (isFirstWord)
+			 {
+			   tupleIds[position] = position;
+			 }
+		       const vector<unsigned int>::const_iterator tuple = getTuple(tupleIds[position]);
+		       unsigned long long key = 0;
+		       for (unsigned int dimensionId = firstDimensionId; dimensionId != endDimensionId; ++dimensionId)
+			 {
+			   key = (key << nbsOfBits[dimensionId]) | (complementedIdBases[dimensionId] - tuple[dimensionId]);
+			 }
+		       keys[position] = key;
+		     }
+		 });
+      isFirstWord = false;
+      for (unsigned int shift = 0; shift < nbOfBitsInWord; shift += 8)
+	{
+	  inParallel(nbOfThreads, nbOfTuples, [&](const unsigned int threadId, const size_t begin, const size_t end)
+		     {
+		       vector<size_t>& digitCountsOfThread = digitCounts[threadId];
+		       fill(digitCountsOfThread.begin(), digitCountsOfThread.end(), 0);
+		       for (size_t position = begin; position != end; ++position)
+			 {
+			   ++digitCountsOfThread[(keys[position] >> shift) & 255];
+			 }
+		     });
+	  // Turn the counts into the positions where the threads start writing, in the order of the digits then of the threads (for stability), unless every key has the same digit
+	  size_t position = 0;
+	  bool isDigitDiscriminating = true;
+	  for (unsigned int digit = 0; digit != 256 && isDigitDiscriminating; ++digit)
+	    {
+	      const size_t nbOfTuplesWithDigit = position;
+	      for (vector<size_t>& digitCountsOfThread : digitCounts)
+		{
+		  const size_t count = digitCountsOfThread[digit];
+		  digitCountsOfThread[digit] = position;
+		  position += count;
+		}
+	      isDigitDiscriminating = position - nbOfTuplesWithDigit != nbOfTuples;
+	    }
+	  if (isDigitDiscriminating)
+	    {
+	      inParallel(nbOfThreads, nbOfTuples, [&](const unsigned int threadId, const size_t begin, const size_t end)
+			 {
+			   vector<size_t>& nextPositions = digitCounts[threadId];
+			   for (size_t position = begin; position != end; ++position)
+			     {
+			       const size_t newPosition = nextPositions[(keys[position] >> shift) & 255]++;
+			       otherKeys[newPosition] = keys[position];
+			       otherTupleIds[newPosition] = tupleIds[position];
+			     }
+			 });
+	      keys.swap(otherKeys);
+	      tupleIds.swap(otherTupleIds);
+	    }
+	}
+    }
+  return tupleIds;
+}
+
+template<typename T> void FuzzyTupleArray::gatherWithoutDuplicates(const vector<T>& tupleIds, const unsigned int nbOfThreads)
+{
+  // Count, for each slice of tupleIds, the tuples that differ from the previous one
+  const size_t nbOfTuples = tupleIds.size();
+  const auto isNew = [this, &tupleIds](const size_t position)
+  {
+    if (!position)
+      {
+	return true;
+      }
+    const vector<unsigned int>::const_iterator tuple = getTuple(tupleIds[position]);
+    return !equal(tuple, tuple + n, getTuple(tupleIds[position - 1]));
+  };
+  vector<size_t> nbsOfNewTuples(nbOfThreads);
+  inParallel(nbOfThreads, nbOfTuples, [&](const unsigned int threadId, const size_t begin, const size_t end)
+	     {
+	       size_t nbOfNewTuples = 0;
+	       for (size_t position = begin; position != end; ++position)
+		 {
+		   nbOfNewTuples += isNew(position);
+		 }
+	       nbsOfNewTuples[threadId] = nbOfNewTuples;
+	     });
+  // Gather the new tuples, every slice writing after the previous ones
+  vector<size_t> firstNewPositions(nbOfThreads);
+  size_t nbOfUniqueTuples = 0;
+  for (unsigned int threadId = 0; threadId != nbOfThreads; ++threadId)
+    {
+      firstNewPositions[threadId] = nbOfUniqueTuples;
+      nbOfUniqueTuples += nbsOfNewTuples[threadId];
+    }
+  vector<unsigned int> sortedIds(nbOfUniqueTuples * n);
+  vector<double> sortedMemberships(memberships.empty() ? 0 : nbOfUniqueTuples);
+  inParallel(nbOfThreads, nbOfTuples, [&](const unsigned int threadId, const size_t begin, const size_t end)
+	     {
+	       size_t newPosition = firstNewPositions[threadId];
+	       for (size_t position = begin; position != end; ++position)
+		 {
+		   if (isNew(position))
+		     {
+		       copy_n(getTuple(tupleIds[position]), n, sortedIds.begin() + newPosition * n);
+		       if (!memberships.empty())
+			 {
+			   sortedMemberships[newPosition] = memberships[tupleIds[position]];
+			 }
+		       ++newPosition;
+		     }
+		 }
+	     });
+  ids.swap(sortedIds);
+  memberships.swap(sortedMemberships);
+}
@@ -0,0 +1,60 @@
+// Copyright 2018-2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef FUZZY_TUPLE_ARRAY_H_
+#define FUZZY_TUPLE_ARRAY_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+class FuzzyTupleArray
+{
+ public:
+  FuzzyTupleArray();
+  FuzzyTupleArray(const unsigned int n);
+
+  unsigned int getN() const;
+  size_t size() const;
+  bool empty() const;
+  vector<unsigned int>::const_iterator getTuple(const size_t tupleId) const;
+  unsigned int getElementId(const size_t tupleId, const unsigned int dimensionId) const;
+  double getMembership(const size_t tupleId) const;
+  double getMembershipSquared(const size_t tupleId) const;
+  const vector<unsigned int>& getIds() const; /* the n ids of the first tuple, then those of the second tuple, etc. */
+  const vector<double>& getMemberships() const; /* empty if every tuple has the same membership */
+
+  void reserve(const size_t nbOfTuples);
+  void clear();			/* also releases the memory */
+  void push_back(const vector<vector<unsigned int>::const_iterator>& tupleIts); /* membership 1; not to be mixed with the other push_back */
+  void push_back(const vector<vector<unsigned int>::const_iterator>& tupleIts, const double membership);
+  void assign(const unsigned int* idBegin, const size_t nbOfTuples, const double* membershipBegin); /* every membership is 1 if membershipBegin is nullptr */
+  void append(FuzzyTupleArray& otherFuzzyTupleArray); /* otherFuzzyTupleArray, whose memberships are stored in the same way, is cleared */
+  void sortAndRemoveDuplicates(const vector<vector<string>>& ids2Labels); /* orders the tuples by decreasing lexicographic order and only keeps the first occurrence of every tuple; ids2Labels only gives the cardinalities */
+  void shiftMemberships(const double shift);
+  void reorder(const vector<unsigned int>& oldOrder2NewOrder);
+  void setNewIds(const unsigned int dimensionId, const vector<unsigned int>& oldIds2NewIdsInDimension);
+  void setNewIds(const vector<vector<unsigned int>>& oldIds2NewIds); /* removes every tuple with a new id equal to numeric_limits<unsigned int>::max(), keeping the order of the others */
+
+ private:
+  unsigned int n;
+  vector<unsigned int> ids;
+  vector<double> memberships;
+  double constantMembership;	/* membership of every tuple if memberships is empty */
+
+  template<typename T> vector<T> radixSortedTupleIds(const vector<vector<string>>& ids2Labels, const unsigned int nbOfThreads) const; /* stable */
+  template<typename T> void gatherWithoutDuplicates(const vector<T>& tupleIds, const unsigned int nbOfThreads);
+
+  static void inParallel(const unsigned int nbOfThreads, const size_t nbOfItems, const function<void(const unsigned int, const size_t, const size_t)>& process); /* process(threadId, begin, end) on nbOfThreads slices of [0, nbOfItems) */
+};
+
+#endif /*FUZZY_TUPLE_ARRAY_H_*/
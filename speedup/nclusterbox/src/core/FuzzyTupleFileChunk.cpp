@@ -0,0 +1,337 @@
+// Copyright 2018-2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "FuzzyTupleFileChunk.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <boost/lexical_cast.hpp>
+
+bool FuzzyTupleFileChunk::isDimensionSeparator[256];
+bool FuzzyTupleFileChunk::isElementSeparator[256];
+#ifdef VERBOSE_PARSER
+string FuzzyTupleFileChunk::tensorFileName;
+#endif
+
+FuzzyTupleFileChunk::FuzzyTupleFileChunk(const char* beginParam, const char* endParam, const unsigned int nbOfDimensions): begin(beginParam), end(endParam), nbOfLines(0), errorLineNb(0), errorMessage(), is01(true), ids2Labels(nbOfDimensions), fuzzyTuples(nbOfDimensions)
+{
+}
+
+void FuzzyTupleFileChunk::setSeparators(const char* inputDimensionSeparator, const char* inputElementSeparator)
+{
+  fill_n(isDimensionSeparator, 256, false);
+  for (; *inputDimensionSeparator; ++inputDimensionSeparator)
+    {
+      isDimensionSeparator[static_cast<unsigned char>(*inputDimensionSeparator)] = true;
+    }
+  fill_n(isElementSeparator, 256, false);
+  for (; *inputElementSeparator; ++inputElementSeparator)
+    {
+      isElementSeparator[static_cast<unsigned char>(*inputElementSeparator)] = true;
+    }
+}
+
+#ifdef VERBOSE_PARSER
+void FuzzyTupleFileChunk::setTensorFileName(const char* tensorFileNameParam)
+{
+  tensorFileName = tensorFileNameParam;
+}
+#endif
+
+unsigned int FuzzyTupleFileChunk::getNbOfTokens(const char* lineBegin, const char* lineEnd)
+{
+  unsigned int nbOfTokens = 0;
+  bool isInToken = false;
+  for (; lineBegin != lineEnd; ++lineBegin)
+    {
+      if (isDimensionSeparator[static_cast<unsigned char>(*lineBegin)])
+	{
+	  isInToken = false;
+	}
+      else
+	{
+	  if (!isInToken)
+	    {
+	      isInToken = true;
+	      ++nbOfTokens;
+	    }
+	}
+    }
+  return nbOfTokens;
+}
+
+bool FuzzyTupleFileChunk::parseMembership(const char* tokenBegin, const char* tokenEnd, double& membership)
+{
+  // Clinger's fast path: a significand with at most 53 bits scaled by an exactly representable power of ten is correctly rounded; otherwise strtod, which correctly rounds as well
+  static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char* characterIt = tokenBegin;
+  bool isNegative = false;
+  if (characterIt != tokenEnd && (*characterIt == '-' || *characterIt == '+'))
+    {
+      isNegative = *characterIt++ == '-';
+    }
+  unsigned long long significand = 0;
+  unsigned int nbOfSignificantDigits = 0;
+  int exponent = 0;
+  bool isSomeDigit = false;
+  for (; characterIt != tokenEnd && *characterIt >= '0' && *characterIt <= '9'; ++characterIt)
+    {
+      isSomeDigit = true;
+      if (significand || *characterIt != '0')
+	{
+	  significand = 10 * significand + (*characterIt - '0');
+	  ++nbOfSignificantDigits;
+	}
+    }
+  if (characterIt != tokenEnd && *characterIt == '.')
+    {
+      for (++characterIt; characterIt != tokenEnd && *characterIt >= '0' && *characterIt <= '9'; ++characterIt)
+	{
+	  isSomeDigit = true;
+	  if (significand || *characterIt != '0')
+	    {
+	      significand = 10 * significand + (*characterIt - '0');
+	      ++nbOfSignificantDigits;
+	    }
+	  --exponent;
+	}
+    }
+  if (!isSomeDigit)
+    {
+      return false;
+    }
+  if (characterIt != tokenEnd && (*characterIt == 'e' || *characterIt == 'E'))
+    {
+      bool isExponentNegative = false;
+      if (++characterIt != tokenEnd && (*characterIt == '-' || *characterIt == '+'))
+	{
+	  isExponentNegative = *characterIt++ == '-';
+	}
+      if (characterIt == tokenEnd || *characterIt < '0' || *characterIt > '9')
+	{
+	  return false;
+	}
+      int explicitExponent = 0;
+      do
+	{
+	  if (explicitExponent < 100000)
+	    {
+	      explicitExponent = 10 * explicitExponent + (*characterIt - '0');
+	    }
+	}
+      while (++characterIt != tokenEnd && *characterIt >= '0' && *characterIt <= '9');
+      if (isExponentNegative)
+	{
+	  exponent -= explicitExponent;
+	}
+      else
+	{
+	  exponent += explicitExponent;
+	}
+    }
+  if (characterIt != tokenEnd)
+    {
+      return false;
+    }
+  if (nbOfSignificantDigits < 20 && significand <= 1ULL << 53 && exponent >= -22 && exponent <= 22)
+    {
+      if (exponent < 0)
+	{
+	  membership = significand / powersOf10[-exponent];
+	}
+      else
+	{
+	  membership = significand * powersOf10[exponent];
+	}
+      if (isNegative)
+	{
+	  membership = -membership;
+	}
+      return true;
+    }
+  membership = strtod(string(tokenBegin, tokenEnd).c_str(), nullptr);
+  return true;
+}
+
+void FuzzyTupleFileChunk::parse()
+{
+  vector<pair<const char*, const char*>> dimensions;
+  vector<unordered_map<string_view, unsigned int>> labels2Ids(ids2Labels.size());
+  vector<vector<unsigned int>> nSet(ids2Labels.size());
+  vector<vector<unsigned int>::const_iterator> tupleIts(ids2Labels.size());
+  for (const char* lineBegin = begin; lineBegin != end; )
+    {
+      ++nbOfLines;
+      const char* lineEnd = static_cast<const char*>(memchr(lineBegin, '\n', end - lineBegin));
+      if (!lineEnd)
+	{
+	  lineEnd = end;
+	}
+      if (!parseLine(lineBegin, lineEnd, dimensions, labels2Ids, nSet, tupleIts))
+	{
+	  errorLineNb = nbOfLines;
+	  return;
+	}
+      if (lineEnd == end)
+	{
+	  return;
+	}
+      lineBegin = lineEnd + 1;
+    }
+}
+
+bool FuzzyTupleFileChunk::parseLine(const char* lineBegin, const char* lineEnd, vector<pair<const char*, const char*>>& dimensions, vector<unordered_map<string_view, unsigned int>>& labels2Ids, vector<vector<unsigned int>>& nSet, vector<vector<unsigned int>::const_iterator>& tupleIts)
+{
+  // Tokenize the line into dimensions
+  dimensions.clear();
+  for (const char* characterIt = lineBegin; ; )
+    {
+      while (characterIt != lineEnd && isDimensionSeparator[static_cast<unsigned char>(*characterIt)])
+	{
+	  ++characterIt;
+	}
+      if (characterIt == lineEnd)
+	{
+	  break;
+	}
+      const char* tokenBegin = characterIt;
+      do
+	{
+	  ++characterIt;
+	}
+      while (characterIt != lineEnd && !isDimensionSeparator[static_cast<unsigned char>(*characterIt)]);
+      dimensions.emplace_back(tokenBegin, characterIt);
+    }
+  if (dimensions.empty())
+    {
+      return true;
+    }
+  // Parse the membership
+  double membership;
+  const pair<const char*, const char*> membershipToken = dimensions.back();
+  if (!parseMembership(membershipToken.first, membershipToken.second, membership) || membership < 0 || membership > 1)
+    {
+      errorMessage = "the membership, " + string(membershipToken.first, membershipToken.second) + ", should be a double in [0, 1]!";
+      return false;
+    }
+  if (membership == 0)
+    {
+      return true;
+    }
+  // Parse the n-set
+  const vector<pair<const char*, const char*>>::const_iterator membershipTokenIt = dimensions.end() - 1;
+  vector<pair<const char*, const char*>>::const_iterator dimensionIt = dimensions.begin();
+  vector<vector<string_view>>::iterator ids2LabelsIt = ids2Labels.begin();
+  vector<vector<unsigned int>>::iterator nSetIt = nSet.begin();
+  for (unordered_map<string_view, unsigned int>& labels2IdsInDimension : labels2Ids)
+    {
+      if (dimensionIt == membershipTokenIt)
+	{
+	  errorMessage = "fewer than the expected " + boost::lexical_cast<string>(nSet.size()) + " dimensions!";
+	  return false;
+	}
+      nSetIt->clear();
+      for (const char* characterIt = dimensionIt->first; ; )
+	{
+	  while (characterIt != dimensionIt->second && isElementSeparator[static_cast<unsigned char>(*characterIt)])
+	    {
+	      ++characterIt;
+	    }
+	  if (characterIt == dimensionIt->second)
+	    {
+	      break;
+	    }
+	  const char* elementBegin = characterIt;
+	  do
+	    {
+	      ++characterIt;
+	    }
+	  while (characterIt != dimensionIt->second && !isElementSeparator[static_cast<unsigned char>(*characterIt)]);
+	  const pair<unordered_map<string_view, unsigned int>::const_iterator, bool> label2Id = labels2IdsInDimension.insert({string_view(elementBegin, characterIt - elementBegin), ids2LabelsIt->size()});
+	  if (label2Id.second)
+	    {
+	      ids2LabelsIt->push_back(label2Id.first->first);
+	    }
+	  nSetIt->push_back(label2Id.first->second);
+	}
+      if (nSetIt->empty())
+	{
+	  errorMessage = "no element in dimension " + boost::lexical_cast<string>(nSetIt - nSet.begin()) + '!';
+	  return false;
+	}
+      ++dimensionIt;
+      ++ids2LabelsIt;
+      ++nSetIt;
+    }
+  if (dimensionIt != membershipTokenIt)
+    {
+      errorMessage = "more than the expected " + boost::lexical_cast<string>(nSet.size()) + " dimensions!";
+      return false;
+    }
+#ifdef VERBOSE_PARSER
+  cout << tensorFileName << ':' << nbOfLines << ": " << string_view(lineBegin, lineEnd - lineBegin) << '\n';
+#endif
+  is01 = is01 && membership == 1;
+  // Enumerate the tuples in nSet, little-endian-like
+  vector<vector<unsigned int>::const_iterator>::iterator tupleItsIt = tupleIts.begin();
+  for (const vector<unsigned int>& dimension : nSet)
+    {
+      *tupleItsIt++ = dimension.begin();
+    }
+  const vector<vector<unsigned int>::const_iterator>::iterator tupleItsEnd = tupleIts.end();
+  do
+    {
+      fuzzyTuples.push_back(tupleIts, membership);
+      tupleItsIt = tupleIts.begin();
+      for (vector<vector<unsigned int>>::const_iterator nSetIt = nSet.begin(); nSetIt != nSet.end() && ++*tupleItsIt == nSetIt->end(); ++nSetIt)
+	{
+	  *tupleItsIt++ = nSetIt->begin();
+	}
+    }
+  while (tupleItsIt != tupleItsEnd);
+  return true;
+}
+
+void FuzzyTupleFileChunk::setGlobalIds(const vector<vector<unsigned int>>& localIds2GlobalIds)
+{
+  fuzzyTuples.setNewIds(localIds2GlobalIds);
+}
+
+unsigned int FuzzyTupleFileChunk::getNbOfLines() const
+{
+  return nbOfLines;
+}
+
+unsigned int FuzzyTupleFileChunk::getErrorLineNb() const
+{
+  return errorLineNb;
+}
+
+const string& FuzzyTupleFileChunk::getErrorMessage() const
+{
+  return errorMessage;
+}
+
+bool FuzzyTupleFileChunk::isEveryMembership1() const
+{
+  return is01;
+}
+
+const vector<vector<string_view>>& FuzzyTupleFileChunk::getIds2Labels() const
+{
+  return ids2Labels;
+}
+
+FuzzyTupleArray& FuzzyTupleFileChunk::getFuzzyTuples()
+{
+  return fuzzyTuples;
+}
@@ -0,0 +1,67 @@
+// Copyright 2018-2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef FUZZY_TUPLE_FILE_CHUNK_H_
+#define FUZZY_TUPLE_FILE_CHUNK_H_
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../../Parameters.h"
+#include "FuzzyTupleArray.h"
+
+class FuzzyTupleFileChunk
+{
+ public:
+  FuzzyTupleFileChunk(const FuzzyTupleFileChunk& otherFuzzyTupleFileChunk) = delete;
+  FuzzyTupleFileChunk(FuzzyTupleFileChunk&& otherFuzzyTupleFileChunk) = default;
+  FuzzyTupleFileChunk(const char* begin, const char* end, const unsigned int nbOfDimensions); /* [begin, end) is a sequence of whole lines */
+
+  FuzzyTupleFileChunk& operator=(const FuzzyTupleFileChunk& otherFuzzyTupleFileChunk) = delete;
+
+  void parse();			/* stops at the first erroneous line */
+  void setGlobalIds(const vector<vector<unsigned int>>& localIds2GlobalIds);
+
+  unsigned int getNbOfLines() const;
+  unsigned int getErrorLineNb() const; /* 0 if no error, otherwise relatively to the beginning of the chunk */
+  const string& getErrorMessage() const;
+  bool isEveryMembership1() const;
+  const vector<vector<string_view>>& getIds2Labels() const; /* local ids, in order of first appearance in the chunk */
+  FuzzyTupleArray& getFuzzyTuples();
+
+  static void setSeparators(const char* inputDimensionSeparator, const char* inputElementSeparator);
+  static unsigned int getNbOfTokens(const char* lineBegin, const char* lineEnd);
+  static bool parseMembership(const char* tokenBegin, const char* tokenEnd, double& membership); /* returns false if [tokenBegin, tokenEnd) is not a decimal number */
+
+#ifdef VERBOSE_PARSER
+  static void setTensorFileName(const char* tensorFileName);
+#endif
+
+ private:
+  const char* begin;
+  const char* end;
+  unsigned int nbOfLines;
+  unsigned int errorLineNb;
+  string errorMessage;
+  bool is01;
+  vector<vector<string_view>> ids2Labels;
+  FuzzyTupleArray fuzzyTuples;
+
+  static bool isDimensionSeparator[256];
+  static bool isElementSeparator[256];
+#ifdef VERBOSE_PARSER
+  static string tensorFileName;
+#endif
+
+  bool parseLine(const char* lineBegin, const char* lineEnd, vector<pair<const char*, const char*>>& dimensions, vector<unordered_map<string_view, unsigned int>>& labels2Ids, vector<vector<unsigned int>>& nSet, vector<vector<unsigned int>::const_iterator>& tupleIts); /* returns false, after setting errorMessage, if the line is erroneous */
+};
+
+#endif /*FUZZY_TUPLE_FILE_CHUNK_H_*/
@@ -10,111 +10,149 @@
 
 #include "FuzzyTupleFileReader.h"
 
-#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <boost/lexical_cast.hpp>
 
-#include "../../Parameters.h"
 #include "../utilities/UsageException.h"
 #include "../utilities/NoInputException.h"
 #include "../utilities/DataFormatException.h"
 
-FuzzyTupleFileReader::FuzzyTupleFileReader(const char* tensorFileNameParam, const char* inputDimensionSeparatorParam, const char* inputElementSeparatorParam): tensorFileName(tensorFileNameParam), tensorStream(nullptr), tensorFile(), inputDimensionSeparator(inputDimensionSeparatorParam), inputElementSeparator(inputElementSeparatorParam), lineNb(0), ids2Labels(), labels2Ids(), nSet(), membership(0), tupleIts()
+FuzzyTupleFileReader::FuzzyTupleFileReader(const char* tensorFileNameParam, const char* inputDimensionSeparator, const char* inputElementSeparator): tensorFileName(tensorFileNameParam), decompressingStreamBuffer(DecompressingStreamBuffer::open(tensorFileNameParam)), decompressedTexts(), text(nullptr), textSize(0), unmappedText(), ids2Labels()
 {
-   if (tensorFileName == "-")
+  FuzzyTupleFileChunk::setSeparators(inputDimensionSeparator, inputElementSeparator);
+#ifdef VERBOSE_PARSER
+  FuzzyTupleFileChunk::setTensorFileName(tensorFileNameParam);
+#endif
+  if (decompressingStreamBuffer)
     {
-      tensorStream.rdbuf(cin.rdbuf());
-      init();
       return;
     }
-   tensorFile.open(tensorFileNameParam);
-   if (!tensorFile)
+  int fileDescriptor = STDIN_FILENO;
+  if (tensorFileName != "-")
     {
-      throw NoInputException(tensorFileNameParam);
+      fileDescriptor = open(tensorFileNameParam, O_RDONLY);
+      if (fileDescriptor == -1)
+	{
+	  throw NoInputException(tensorFileNameParam);
+	}
     }
-  tensorStream.rdbuf(tensorFile.rdbuf());
-  init();
-}
-
-void FuzzyTupleFileReader::init()
-{
-  if (tensorStream.eof())
+  struct stat fileStatus;
+  if (fstat(fileDescriptor, &fileStatus) == 0 && S_ISREG(fileStatus.st_mode) && fileStatus.st_size)
     {
-      throw UsageException(("No fuzzy tuple in " + tensorFileName + '!').c_str());
+      void* mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+      if (mapping != MAP_FAILED)
+	{
+	  madvise(mapping, fileStatus.st_size, MADV_WILLNEED);
+	  text = static_cast<const char*>(mapping);
+	  textSize = fileStatus.st_size;
+	  if (fileDescriptor != STDIN_FILENO)
+	    {
+	      close(fileDescriptor);
+	    }
+	  return;
+	}
     }
-  ++lineNb;
-  string nSetString;
-  getline(tensorStream, nSetString);
-  tokenizer<char_separator<char>> dimensions(nSetString, inputDimensionSeparator);
-  tokenizer<char_separator<char>>::const_iterator dimensionIt = dimensions.begin();
-  if (dimensionIt == dimensions.end())
+  // Not mappable: copy it
+  char buffer[1 << 16];
+  for (ssize_t nbOfReadBytes = ::read(fileDescriptor, buffer, sizeof(buffer)); nbOfReadBytes > 0; nbOfReadBytes = ::read(fileDescriptor, buffer, sizeof(buffer)))
     {
-      init();
-      return;
+      unmappedText.append(buffer, nbOfReadBytes);
     }
-  ids2Labels.resize(std::distance(++dimensionIt, dimensions.end()));
-  if (ids2Labels.size() < 2)
+  if (fileDescriptor != STDIN_FILENO)
     {
-      throw DataFormatException(tensorFileName.c_str(), lineNb, (lexical_cast<string>(ids2Labels.size()) + " dimension, but at least 2 are required!").c_str());
+      close(fileDescriptor);
     }
-  labels2Ids.resize(ids2Labels.size());
-  nSet.resize(ids2Labels.size());
-  tupleIts.resize(ids2Labels.size());
-  while (!parseLine(dimensions.begin(), dimensions.end()))
+  text = unmappedText.data();
+  textSize = unmappedText.size();
+}
+
+FuzzyTupleFileReader::~FuzzyTupleFileReader()
+{
+  delete decompressingStreamBuffer;
+  if (textSize && text != unmappedText.data())
     {
-      if (tensorStream.eof())
-	{
-	  throw UsageException(("All fuzzy tuples in " + tensorFileName + " have null membership degrees!").c_str());
-	}
-      ++lineNb;
-      getline(tensorStream, nSetString);
-      dimensions = tokenizer<char_separator<char>>(nSetString, inputDimensionSeparator);
+      munmap(const_cast<char*>(text), textSize);
     }
-#ifdef VERBOSE_PARSER
-  cout << tensorFileName << ':' << lineNb << ": " << nSetString << '\n';
-#endif
 }
 
-pair<vector<FuzzyTuple>, bool> FuzzyTupleFileReader::read()
+pair<FuzzyTupleArray, bool> FuzzyTupleFileReader::read()
 {
-  bool is01 = true;
-  const vector<vector<unsigned int>::const_iterator>::iterator tupleItsEnd = tupleIts.end();
-  for (vector<FuzzyTuple> fuzzyTuples; ; )
+  vector<FuzzyTupleFileChunk> chunks;
+  if (decompressingStreamBuffer)
     {
-      fuzzyTuples.emplace_back(tupleIts, membership);
-      // Advance tuple in nSet, little-endian-like
-      vector<vector<unsigned int>::const_iterator>::iterator tupleItsIt = tupleIts.begin();
-      for (vector<vector<unsigned int>>::const_iterator nSetIt = nSet.begin(); nSetIt != nSet.end() && ++*tupleItsIt == nSetIt->end(); ++nSetIt)
+      chunks = parseDecompressedText();
+    }
+  else
+    {
+      const unsigned int nbOfDimensions = getNbOfDimensions(text, text + textSize);
+      if (!nbOfDimensions)
 	{
-	  *tupleItsIt++ = nSetIt->begin();
+	  throw UsageException(("No fuzzy tuple in " + tensorFileName + '!').c_str());
 	}
-      if (tupleItsIt == tupleItsEnd)
+      chunks = split(nbOfDimensions);
+      // Parse the chunks in parallel
+      const vector<FuzzyTupleFileChunk>::iterator chunkEnd = chunks.end();
+      vector<thread> threads;
+      threads.reserve(chunks.size() - 1);
+      for (vector<FuzzyTupleFileChunk>::iterator chunkIt = chunks.begin(); ++chunkIt != chunkEnd; )
 	{
-	  // All tuples in nSet enumerated: find and parse the next line (if any) with nonzero membership
-	  for (; ; )
-	    {
-	      if (tensorStream.eof())
-		{
-		  tensorFile.close();
-		  fuzzyTuples.shrink_to_fit();
-		  stable_sort(fuzzyTuples.begin(), fuzzyTuples.end());
-		  fuzzyTuples.erase(unique(fuzzyTuples.begin(), fuzzyTuples.end()), fuzzyTuples.end());
-		  return {fuzzyTuples, is01};
-		}
-	      ++lineNb;
-	      string nSetString;
-	      getline(tensorStream, nSetString);
-	      tokenizer<char_separator<char>> dimensions(nSetString, inputDimensionSeparator);
-	      if (dimensions.begin() != dimensions.end() && parseLine(dimensions.begin(), dimensions.end()))
-		{
-#ifdef VERBOSE_PARSER
-		  cout << tensorFileName << ':' << lineNb << ": " << nSetString << '\n';
-#endif
-		  break;
-		}
-	    }
-	  is01 = is01 && membership == 1;
+	  threads.emplace_back(&FuzzyTupleFileChunk::parse, &*chunkIt);
+	}
+      chunks.front().parse();
+      for (thread& t : threads)
+	{
+	  t.join();
 	}
     }
+  const vector<FuzzyTupleFileChunk>::iterator chunkEnd = chunks.end();
+  // Report the first erroneous line, if any
+  unsigned int nbOfPreviousLines = 0;
+  for (const FuzzyTupleFileChunk& chunk : chunks)
+    {
+      if (chunk.getErrorLineNb())
+	{
+	  throw DataFormatException(tensorFileName.c_str(), nbOfPreviousLines + chunk.getErrorLineNb(), chunk.getErrorMessage().c_str());
+	}
+      nbOfPreviousLines += chunk.getNbOfLines();
+    }
+  {
+    // Turn the local ids into global ones, in parallel (the local ids in the first chunk already are global)
+    const vector<vector<vector<unsigned int>>> localIds2GlobalIds = setIds2Labels(chunks);
+    vector<vector<vector<unsigned int>>>::const_iterator localIds2GlobalIdsIt = localIds2GlobalIds.begin();
+    vector<thread> threads;
+    threads.reserve(chunks.size() - 1);
+    for (vector<FuzzyTupleFileChunk>::iterator chunkIt = chunks.begin(); ++chunkIt != chunkEnd; )
+      {
+	threads.emplace_back(&FuzzyTupleFileChunk::setGlobalIds, &*chunkIt, cref(*++localIds2GlobalIdsIt));
+      }
+    for (thread& t : threads)
+      {
+	t.join();
+      }
+  }
+  // Concatenate the fuzzy tuples in the order of the file, so that only the first occurrence of a tuple is kept
+  bool is01 = true;
+  for (const FuzzyTupleFileChunk& chunk : chunks)
+    {
+      is01 = is01 && chunk.isEveryMembership1();
+    }
+  FuzzyTupleArray fuzzyTuples(chunks.front().getIds2Labels().size());
+  for (FuzzyTupleFileChunk& chunk : chunks)
+    {
+      fuzzyTuples.append(chunk.getFuzzyTuples());
+    }
+  if (fuzzyTuples.empty())
+    {
+      throw UsageException(("All fuzzy tuples in " + tensorFileName + " have null membership degrees!").c_str());
+    }
+  fuzzyTuples.sortAndRemoveDuplicates(ids2Labels);
+  return {std::move(fuzzyTuples), is01};
 }
 
 vector<vector<string>>& FuzzyTupleFileReader::getIds2Labels()
@@ -122,68 +160,179 @@ vector<vector<string>>& FuzzyTupleFileReader::getIds2Labels()
   return ids2Labels;
 }
 
-bool FuzzyTupleFileReader::parseLine(const tokenizer<char_separator<char>>::const_iterator dimensionBegin, const tokenizer<char_separator<char>>::const_iterator dimensionEnd)
+vector<FuzzyTupleFileChunk> FuzzyTupleFileReader::parseDecompressedText()
 {
-  tokenizer<char_separator<char>>::const_iterator dimensionIt = dimensionBegin;
-  tokenizer<char_separator<char>>::const_iterator membershipIt = dimensionBegin;
-  while (++dimensionIt != dimensionEnd)
-    {
-      membershipIt = dimensionIt;
-    }
+#ifdef VERBOSE_PARSER
+  // One chunk at a time, so that the lines are printed in order
+  const size_t maxNbOfThreads = 1;
+#else
+  const size_t maxNbOfThreads = max(thread::hardware_concurrency(), 1U);
+#endif
+  deque<FuzzyTupleFileChunk> chunks; /* unlike a vector, never moves the chunks being parsed */
+  deque<thread> threads;
   try
     {
-      membership = lexical_cast<double>(*membershipIt);
-      if (membership == 0)
+      unsigned int nbOfDimensions = 0;
+      string pendingText;	/* decompressed characters not yet in a chunk */
+      const auto parsePendingText = [this, maxNbOfThreads, &nbOfDimensions, &pendingText, &chunks, &threads]()
+      {
+	decompressedTexts.emplace_back(std::move(pendingText));
+	const string& chunkText = decompressedTexts.back();
+	chunks.emplace_back(chunkText.data(), chunkText.data() + chunkText.size(), nbOfDimensions);
+	if (threads.size() == maxNbOfThreads)
+	  {
+	    threads.front().join();
+	    threads.pop_front();
+	  }
+	threads.emplace_back(&FuzzyTupleFileChunk::parse, &chunks.back());
+      };
+      string block;
+      while (decompressingStreamBuffer->getBlock(block))
+	{
+	  const size_t lastLineEnd = block.rfind('\n');
+	  if (lastLineEnd == string::npos)
+	    {
+	      pendingText.append(block);
+	      continue;
+	    }
+	  pendingText.append(block, 0, lastLineEnd + 1);
+	  if (!nbOfDimensions)
+	    {
+	      nbOfDimensions = getNbOfDimensions(pendingText.data(), pendingText.data() + pendingText.size());
+	      if (!nbOfDimensions)
+		{
+		  pendingText.append(block, lastLineEnd + 1, string::npos);
+		  continue;
+		}
+	    }
+	  parsePendingText();
+	  pendingText.assign(block, lastLineEnd + 1, string::npos);
+	}
+      if (!nbOfDimensions)
 	{
-	  return false;
+	  nbOfDimensions = getNbOfDimensions(pendingText.data(), pendingText.data() + pendingText.size());
+	  if (!nbOfDimensions)
+	    {
+	      throw UsageException(("No fuzzy tuple in " + tensorFileName + '!').c_str());
+	    }
 	}
-      if (membership < 0 || membership > 1)
+      if (!pendingText.empty())
 	{
-	  throw bad_lexical_cast();
+	  parsePendingText();
 	}
     }
-  catch (bad_lexical_cast &)
+  catch (...)
     {
-      throw DataFormatException(tensorFileName.c_str(), lineNb, ("the membership, " + *membershipIt + ", should be a double in [0, 1]!").c_str());
+      for (thread& t : threads)
+	{
+	  t.join();
+	}
+      throw;
     }
-  vector<vector<string>>::iterator ids2LabelsIt = ids2Labels.begin();
-  dimensionIt = dimensionBegin;
-  vector<vector<unsigned int>>::iterator nSetIt = nSet.begin();
-  for (unordered_map<string, unsigned int>& labels2IdsInDimension : labels2Ids)
+  for (thread& t : threads)
     {
-      nSetIt->clear();
-      tokenizer<char_separator<char>> elements(*dimensionIt, inputElementSeparator);
-      const tokenizer<char_separator<char>>::const_iterator elementEnd = elements.end();
-      tokenizer<char_separator<char>>::const_iterator elementIt = elements.begin();
-      if (elementIt == elementEnd)
+      t.join();
+    }
+  delete decompressingStreamBuffer;
+  decompressingStreamBuffer = nullptr;
+  vector<FuzzyTupleFileChunk> parsedChunks;
+  parsedChunks.reserve(chunks.size());
+  for (FuzzyTupleFileChunk& chunk : chunks)
+    {
+      parsedChunks.emplace_back(std::move(chunk));
+    }
+  return parsedChunks;
+}
+
+unsigned int FuzzyTupleFileReader::getNbOfDimensions(const char* begin, const char* end) const
+{
+  unsigned int lineNb = 0;
+  for (const char* lineBegin = begin; lineBegin != end; )
+    {
+      ++lineNb;
+      const char* lineEnd = static_cast<const char*>(memchr(lineBegin, '\n', end - lineBegin));
+      if (!lineEnd)
 	{
-	  throw DataFormatException(tensorFileName.c_str(), lineNb, ("no element in dimension " + lexical_cast<string>(nSetIt - nSet.begin()) + '!').c_str());
+	  lineEnd = end;
 	}
-      do
+      const unsigned int nbOfTokens = FuzzyTupleFileChunk::getNbOfTokens(lineBegin, lineEnd);
+      if (nbOfTokens)
 	{
-	  const pair<unordered_map<string, unsigned int>::const_iterator, bool> label2Id = labels2IdsInDimension.insert({*elementIt, ids2LabelsIt->size()});
-	  if (label2Id.second)
+	  if (nbOfTokens < 3)
 	    {
-	      ids2LabelsIt->push_back(*elementIt);
+	      throw DataFormatException(tensorFileName.c_str(), lineNb, (boost::lexical_cast<string>(nbOfTokens - 1) + " dimension, but at least 2 are required!").c_str());
 	    }
-	  nSetIt->push_back(label2Id.first->second);
+	  return nbOfTokens - 1;
 	}
-      while (++elementIt != elementEnd);
-      if (++dimensionIt == dimensionEnd)
+      if (lineEnd == end)
 	{
-	  throw DataFormatException(tensorFileName.c_str(), lineNb, ("fewer than the expected " + lexical_cast<string>(nSet.size()) + " dimensions!").c_str());
+	  break;
 	}
-      ++ids2LabelsIt;
-      ++nSetIt;
+      lineBegin = lineEnd + 1;
     }
-  if (dimensionIt != membershipIt)
+  return 0;
+}
+
+vector<FuzzyTupleFileChunk> FuzzyTupleFileReader::split(const unsigned int nbOfDimensions) const
+{
+#ifdef VERBOSE_PARSER
+  // A single chunk, so that the lines are printed in order
+  const size_t nbOfChunks = 1;
+#else
+  const size_t nbOfChunks = min(static_cast<size_t>(max(thread::hardware_concurrency(), 1U)), (textSize >> 20) + 1);
+#endif
+  vector<FuzzyTupleFileChunk> chunks;
+  chunks.reserve(nbOfChunks);
+  const char* chunkBegin = text;
+  const char* const textEnd = text + textSize;
+  for (size_t chunkId = 1; chunkId != nbOfChunks; ++chunkId)
     {
-      throw DataFormatException(tensorFileName.c_str(), lineNb, ("more than the expected " + lexical_cast<string>(nSet.size()) + " dimensions!").c_str());
+      const char* chunkEnd = text + textSize / nbOfChunks * chunkId;
+      if (chunkEnd >= chunkBegin)
+	{
+	  chunkEnd = static_cast<const char*>(memchr(chunkEnd, '\n', textEnd - chunkEnd));
+	  if (!chunkEnd)
+	    {
+	      break;
+	    }
+	  chunks.emplace_back(chunkBegin, ++chunkEnd, nbOfDimensions);
+	  chunkBegin = chunkEnd;
+	}
     }
-  vector<vector<unsigned int>::const_iterator>::iterator tupleItsIt = tupleIts.begin();
-  for (const vector<unsigned int>& dimension : nSet)
+  chunks.emplace_back(chunkBegin, textEnd, nbOfDimensions);
+  return chunks;
+}
+
+vector<vector<vector<unsigned int>>> FuzzyTupleFileReader::setIds2Labels(const vector<FuzzyTupleFileChunk>& chunks)
+{
+  ids2Labels.resize(chunks.front().getIds2Labels().size());
+  vector<unordered_map<string_view, unsigned int>> labels2Ids(ids2Labels.size());
+  vector<vector<vector<unsigned int>>> localIds2GlobalIds;
+  localIds2GlobalIds.reserve(chunks.size());
+  for (const FuzzyTupleFileChunk& chunk : chunks)
     {
-      *tupleItsIt++ = dimension.begin();
+      localIds2GlobalIds.emplace_back();
+      vector<vector<unsigned int>>& localIds2GlobalIdsInChunk = localIds2GlobalIds.back();
+      localIds2GlobalIdsInChunk.reserve(ids2Labels.size());
+      vector<vector<string>>::iterator ids2LabelsIt = ids2Labels.begin();
+      vector<unordered_map<string_view, unsigned int>>::iterator labels2IdsIt = labels2Ids.begin();
+      for (const vector<string_view>& localIds2LabelsInDimension : chunk.getIds2Labels())
+	{
+	  localIds2GlobalIdsInChunk.emplace_back();
+	  vector<unsigned int>& localIds2GlobalIdsInDimension = localIds2GlobalIdsInChunk.back();
+	  localIds2GlobalIdsInDimension.reserve(localIds2LabelsInDimension.size());
+	  for (const string_view label : localIds2LabelsInDimension)
+	    {
+	      const pair<unordered_map<string_view, unsigned int>::const_iterator, bool> label2Id = labels2IdsIt->insert({label, ids2LabelsIt->size()});
+	      if (label2Id.second)
+		{
+		  ids2LabelsIt->emplace_back(label);
+		}
+	      localIds2GlobalIdsInDimension.push_back(label2Id.first->second);
+	    }
+	  ++ids2LabelsIt;
+	  ++labels2IdsIt;
+	}
     }
-  return true;
+  return localIds2GlobalIds;
 }
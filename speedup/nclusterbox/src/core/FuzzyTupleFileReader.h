@@ -11,38 +11,37 @@
 #ifndef FUZZY_TUPLE_FILE_READER_H_
 #define FUZZY_TUPLE_FILE_READER_H_
 
-#include <unordered_map>
-#include <fstream>
-#include <boost/tokenizer.hpp>
+#include <deque>
 
-#include "FuzzyTuple.h"
-
-using namespace boost;
+#include "FuzzyTupleFileChunk.h"
+#include "DecompressingStreamBuffer.h"
 
 class FuzzyTupleFileReader
 {
  public:
+  FuzzyTupleFileReader(const FuzzyTupleFileReader& otherFuzzyTupleFileReader) = delete;
   FuzzyTupleFileReader(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator);
+  ~FuzzyTupleFileReader();
+
+  FuzzyTupleFileReader& operator=(const FuzzyTupleFileReader& otherFuzzyTupleFileReader) = delete;
 
-  pair<vector<FuzzyTuple>, bool> read(); /* returns the unique fuzzy tuples, ordered by FuzzyTuple::operator<, and whether they all have memberships equal to 1 (or 0, but these are not returned) */
+  pair<FuzzyTupleArray, bool> read(); /* returns the unique fuzzy tuples, in decreasing lexicographic order, and whether they all have memberships equal to 1 (or 0, but these are not returned) */
 
   vector<vector<string>>& getIds2Labels();
 
  private:
   const string tensorFileName;
-  istream tensorStream;
-  ifstream tensorFile;
-  const char_separator<char> inputDimensionSeparator;
-  const char_separator<char> inputElementSeparator;
-  unsigned int lineNb;
+  DecompressingStreamBuffer* decompressingStreamBuffer; /* nullptr unless the tensor file is compressed or a pipe, in which case text is unused */
+  deque<string> decompressedTexts; /* the texts of the chunks parsed while decompressing */
+  const char* text;		/* the whole tensor file, memory-mapped unless it cannot be, in which case it is copied into unmappedText */
+  size_t textSize;
+  string unmappedText;
   vector<vector<string>> ids2Labels;
-  vector<unordered_map<string, unsigned int>> labels2Ids;
-  vector<vector<unsigned int>> nSet;
-  double membership;
-  vector<vector<unsigned int>::const_iterator> tupleIts;
 
-  void init();			/* membership remains 0 if and only if the tensor is empty */
-  bool parseLine(const tokenizer<char_separator<char>>::const_iterator dimensionBegin, const tokenizer<char_separator<char>>::const_iterator dimensionEnd); /* returns whether the line is to be considered (nonzero membership) */
+  vector<FuzzyTupleFileChunk> parseDecompressedText(); /* in chunks of whole lines, of one block each, parsed in parallel with the decompression */
+  unsigned int getNbOfDimensions(const char* begin, const char* end) const; /* from the first line with some token in [begin, end); 0 if there is none */
+  vector<FuzzyTupleFileChunk> split(const unsigned int nbOfDimensions) const; /* in as many chunks of whole lines as there are hardware threads, but of at least 1 MiB each */
+  vector<vector<vector<unsigned int>>> setIds2Labels(const vector<FuzzyTupleFileChunk>& chunks); /* returns, for each chunk, the mapping from its local ids to the global ones, which are assigned in order of first appearance in the file */
 };
 
 #endif /*FUZZY_TUPLE_FILE_READER_H_*/
@@ -11,18 +11,48 @@
 #include "ModifiedPattern.h"
 
 #include <algorithm>
+#include <limits>
 
 #include "ConcurrentPatternPool.h"
 #include "VisitedPatterns.h"
 
-unordered_set<vector<vector<unsigned int>>, boost::hash<vector<vector<unsigned int>>>> ModifiedPattern::distinctCandidateVariables;
+unordered_map<NSetFingerprint, vector<vector<unsigned int>>, NSetFingerprint::Hash> ModifiedPattern::distinctCandidateVariables;
+vector<ModifiedPattern::OutputFingerprints> ModifiedPattern::outputFingerprints;
 
 unsigned int ModifiedPattern::nbOfOutputPatterns;
+atomic<unsigned long long> ModifiedPattern::nbOfPrunedClimbs(0);
+atomic<unsigned long long> ModifiedPattern::nbOfStepsInCompleteClimbs(0);
+atomic<unsigned long long> ModifiedPattern::nbOfCompleteClimbs(0);
+atomic<unsigned long long> ModifiedPattern::nbOfStepsInHopelessClimbs(0);
+atomic<unsigned long long> ModifiedPattern::nbOfHopelessClimbs(0);
 mutex ModifiedPattern::candidateVariablesLock;
+mutex ModifiedPattern::outputLock;
+#ifdef NB_OF_ALLOCATIONS
+atomic<unsigned long long> ModifiedPattern::nbOfInitialPatterns(0);
+atomic<unsigned long long> ModifiedPattern::nbOfAllocations(0);
+#endif
+
+unsigned int ModifiedPattern::nbOfBestGs = 0;
+priority_queue<double, vector<double>, greater<double>> ModifiedPattern::bestGs;
+atomic<double> ModifiedPattern::hopelessThreshold(numeric_limits<double>::lowest());
+mutex ModifiedPattern::bestGsLock;
 
 const AbstractRoughTensor* ModifiedPattern::roughTensor;
 bool ModifiedPattern::isEveryVisitedPatternStored;
+bool ModifiedPattern::isTensorFlat;
 Trie ModifiedPattern::tensor;
+FlatTrie ModifiedPattern::flatTensor;
+
+// Maximal number of initial patterns taken at once from ConcurrentPatternPool
+static const unsigned int maxNbOfPatternsPerBatch = 64;
+// Number of local maxima a thread buffers before outputting them at once, if AbstractRoughTensor::isDirectOutput()
+static const unsigned int nbOfPatternsPerOutput = 64;
+// Number of shards of ModifiedPattern::outputFingerprints
+static const unsigned int nbOfOutputFingerprintShards = 64;
+
+ModifiedPattern::OutputFingerprints::OutputFingerprints(): lock(), fingerprints()
+{
+}
 
 void addFirstNonInitialAndSubsequentInitialInDimension(const vector<unsigned int>& dimension, vector<unsigned int>& firstNonInitialAndSubsequentInitial)
 {
@@ -36,7 +66,7 @@ void addFirstNonInitialAndSubsequentInitialInDimension(const vector<unsigned int
   firstNonInitialAndSubsequentInitial.insert(firstNonInitialAndSubsequentInitial.end(), dimension.begin() + elementId, dimension.end());
 }
 
-ModifiedPattern::ModifiedPattern(): nSet(), area(), membershipSum(), sumsOnHyperplanes(), nextStep(), bestG(), bestDimensionIt(), bestSumIt(), candidateVariables()
+ModifiedPattern::ModifiedPattern(): initialPatterns(), nextInitialPatternIt(initialPatterns.end()), nSet(AbstractRoughTensor::getCardinalities().size()), fingerprint(), area(), membershipSum(), sumsOnHyperplanes(), nextStep(), bestG(), bestDimensionIt(), bestSumIt(), singleElement(1), optimisticIncrease(0), optimisticArea(1), nbOfStepsInClimb(0), nbOfStepsInCompleteClimbsOfThread(0), nbOfCompleteClimbsOfThread(0), nbOfStepsInHopelessClimbsOfThread(0), nbOfHopelessClimbsOfThread(0), patternsToOutput(), candidateVariables(), distinctCandidateVariablesOfThread()
 {
   const vector<unsigned int>& cardinalities = AbstractRoughTensor::getCardinalities();
   vector<unsigned int>::const_iterator cardinalityIt = cardinalities.begin();
@@ -53,36 +83,105 @@ ModifiedPattern::ModifiedPattern(): nSet(), area(), membershipSum(), sumsOnHyper
 
 ModifiedPattern::~ModifiedPattern()
 {
-  if (isEveryVisitedPatternStored && !AbstractRoughTensor::isDirectOutput())
+  nbOfStepsInCompleteClimbs += nbOfStepsInCompleteClimbsOfThread;
+  nbOfCompleteClimbs += nbOfCompleteClimbsOfThread;
+  nbOfStepsInHopelessClimbs += nbOfStepsInHopelessClimbsOfThread;
+  nbOfHopelessClimbs += nbOfHopelessClimbsOfThread;
+  if (AbstractRoughTensor::isDirectOutput())
+    {
+      flushPatternsToOutput();
+      return;
+    }
+  const lock_guard<mutex> lock(candidateVariablesLock);
+  if (isEveryVisitedPatternStored)
     {
-      const lock_guard<mutex> lock(candidateVariablesLock);
       move(candidateVariables.begin(), candidateVariables.end(), back_inserter<vector<vector<vector<unsigned int>>>>(AbstractRoughTensor::candidateVariables));
+      return;
+    }
+  if (distinctCandidateVariables.empty())
+    {
+      distinctCandidateVariables.swap(distinctCandidateVariablesOfThread);
+      return;
+    }
+  for (pair<const NSetFingerprint, vector<vector<unsigned int>>>& distinctCandidateVariable : distinctCandidateVariablesOfThread)
+    {
+      distinctCandidateVariables.try_emplace(distinctCandidateVariable.first, std::move(distinctCandidateVariable.second));
     }
 }
 
 void ModifiedPattern::modify()
 {
+#ifdef NB_OF_ALLOCATIONS
+  const unsigned long long nbOfAllocationsBefore = AllocationCounter::getNbOfAllocationsInThread();
+#endif
   ModifiedPattern().doModify();
+#ifdef NB_OF_ALLOCATIONS
+  nbOfAllocations += AllocationCounter::getNbOfAllocationsInThread() - nbOfAllocationsBefore;
+#endif
 }
 
 void ModifiedPattern::grow()
 {
+#ifdef NB_OF_ALLOCATIONS
+  const unsigned long long nbOfAllocationsBefore = AllocationCounter::getNbOfAllocationsInThread();
+#endif
   ModifiedPattern().doGrow();
+#ifdef NB_OF_ALLOCATIONS
+  nbOfAllocations += AllocationCounter::getNbOfAllocationsInThread() - nbOfAllocationsBefore;
+#endif
+}
+
+bool ModifiedPattern::nextInitialPattern()
+{
+  if (nextInitialPatternIt == initialPatterns.end())
+    {
+      if (!ConcurrentPatternPool::nextBatch(maxNbOfPatternsPerBatch, initialPatterns))
+	{
+	  return false;
+	}
+      nextInitialPatternIt = initialPatterns.begin();
+    }
+  // Assigning, rather than moving, keeps the capacities the dimensions of nSet reached with the previous patterns: insertions do not reallocate
+  vector<vector<unsigned int>>::iterator dimensionIt = nSet.begin();
+  for (const vector<unsigned int>& initialDimension : *nextInitialPatternIt)
+    {
+      dimensionIt->assign(initialDimension.begin(), initialDimension.end());
+      ++dimensionIt;
+    }
+  ++nextInitialPatternIt;
+  fingerprint.set(nSet);
+#ifdef NB_OF_ALLOCATIONS
+  ++nbOfInitialPatterns;
+#endif
+  return true;
+}
+
+bool ModifiedPattern::isVisited() const
+{
+#if REMEMBER == 1
+  return VisitedPatterns::visited(fingerprint);
+#else  // REMEMBER == 2
+  return VisitedPatterns::visited(nSet);
+#endif
 }
 
 void ModifiedPattern::doModify()
 {
-  for (nSet = ConcurrentPatternPool::next(); !nSet.empty(); nSet = ConcurrentPatternPool::next())
+  while (nextInitialPattern())
     {
-      if (isEveryVisitedPatternStored && VisitedPatterns::visited(nSet))
+      if (isEveryVisitedPatternStored && isVisited())
 	{
+	  ++nbOfPrunedClimbs;
 	  continue;
 	}
       init();
-      do
+      nbOfStepsInClimb = 0;
+      for (; ; )
 	{
 	  // Decide modification step
 	  nextStep = stop;
+	  optimisticIncrease = 0;
+	  optimisticArea = 1;
 	  vector<vector<int>>::const_iterator sumsInDimensionIt = sumsOnHyperplanes.begin();
 	  vector<vector<unsigned int>>::iterator dimensionIt = nSet.begin();
 	  considerDimensionForNextModificationStep(dimensionIt, *sumsInDimensionIt);
@@ -98,17 +197,32 @@ void ModifiedPattern::doModify()
 #ifdef ASSERT
 	  assertAreaAndSums();
 #endif
+	  if (nbOfBestGs && nextStep != stop && isHopeless())
+	    {
+	      nbOfStepsInHopelessClimbsOfThread += nbOfStepsInClimb;
+	      ++nbOfHopelessClimbsOfThread;
+	      break;
+	    }
+	  if (!doStep())
+	    {
+	      if (nextStep == stop)
+		{
+		  nbOfStepsInCompleteClimbsOfThread += nbOfStepsInClimb;
+		  ++nbOfCompleteClimbsOfThread;
+		}
+	      break;
+	    }
+	  ++nbOfStepsInClimb;
 	}
-      while (doStep());
     }
 }
 
 void ModifiedPattern::doGrow()
 {
-  for (nSet = ConcurrentPatternPool::next(); !nSet.empty(); nSet = ConcurrentPatternPool::next())
+  while (nextInitialPattern())
     {
       // assuming no input pattern is a subpattern of another input pattern; if not, the commented code below is useful to never reconsider several times the superpattern (and have it output several times, if AbstractRoughTensor::isDirectOutput())
-//       if (isEveryVisitedPatternStored && VisitedPatterns::visited(nSet))
+//       if (isEveryVisitedPatternStored && isVisited())
 // 	{
 // 	  continue;
 // 	}
@@ -157,16 +271,68 @@ unsigned int ModifiedPattern::getNbOfOutputPatterns()
   return nbOfOutputPatterns;
 }
 
+unsigned long long ModifiedPattern::getNbOfPrunedClimbs()
+{
+  return nbOfPrunedClimbs;
+}
+
+unsigned long long ModifiedPattern::getNbOfHopelessClimbs()
+{
+  return nbOfHopelessClimbs;
+}
+
+double ModifiedPattern::getAverageNbOfStepsInHopelessClimbs()
+{
+  if (nbOfHopelessClimbs)
+    {
+      return static_cast<double>(nbOfStepsInHopelessClimbs) / nbOfHopelessClimbs;
+    }
+  return 0;
+}
+
+double ModifiedPattern::getAverageNbOfStepsInCompleteClimbs()
+{
+  if (nbOfCompleteClimbs)
+    {
+      return static_cast<double>(nbOfStepsInCompleteClimbs) / nbOfCompleteClimbs;
+    }
+  return 0;
+}
+
+#ifdef NB_OF_ALLOCATIONS
+double ModifiedPattern::getNbOfAllocationsPerInitialPattern()
+{
+  if (nbOfInitialPatterns)
+    {
+      return static_cast<double>(nbOfAllocations) / nbOfInitialPatterns;
+    }
+  return 0;
+}
+#endif
+
 void ModifiedPattern::insertCandidateVariables()
 {
-  tensor.clearAndFree();
+  if (isTensorFlat)
+    {
+      flatTensor.clearAndFree();
+    }
+  else
+    {
+      tensor.clearAndFree();
+    }
   if (isEveryVisitedPatternStored)
     {
       VisitedPatterns::clear();
       return;
     }
-  move(distinctCandidateVariables.begin(), distinctCandidateVariables.end(), back_inserter<vector<vector<vector<unsigned int>>>>(AbstractRoughTensor::candidateVariables));
+  AbstractRoughTensor::candidateVariables.reserve(AbstractRoughTensor::candidateVariables.size() + distinctCandidateVariables.size());
+  for (pair<const NSetFingerprint, vector<vector<unsigned int>>>& distinctCandidateVariable : distinctCandidateVariables)
+    {
+      AbstractRoughTensor::candidateVariables.emplace_back(std::move(distinctCandidateVariable.second));
+    }
   distinctCandidateVariables.clear();
+  outputFingerprints.clear();
+  outputFingerprints.shrink_to_fit();
 }
 
 void ModifiedPattern::init()
@@ -182,11 +348,25 @@ void ModifiedPattern::init()
   while (++dimensionIt != dimensionEnd);
   if (Trie::is01)
     {
-      membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+      if (isTensorFlat)
+	{
+	  membershipSum = flatTensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	}
+      else
+	{
+	  membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	}
     }
   else
     {
-      membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes);
+      if (isTensorFlat)
+	{
+	  membershipSum = flatTensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes);
+	}
+      else
+	{
+	  membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes);
+	}
     }
   bestG = abs(static_cast<double>(membershipSum)) * membershipSum / area;
 #ifdef DEBUG_MODIFY
@@ -198,13 +378,28 @@ void ModifiedPattern::init()
 
 void ModifiedPattern::considerDimensionForNextModificationStep(const vector<vector<unsigned int>>::iterator dimensionIt, const vector<int>& sumsInDimension)
 {
+  // Along the scan, what isHopeless needs: the increase of the membership sum if every absent slice with a positive sum was added and every present slice with a negative sum was removed, and the number of such present slices
+  long long optimisticIncreaseInDimension = 0;
+  unsigned int nbOfRemovableElements = 0;
   if (sumsInDimension.size() == dimensionIt->size())
     {
       // Every element in the dimension of the tensor is present
+      vector<int>::const_iterator bestDecreasingSumInDimensionIt = sumsInDimension.begin();
+      for (vector<int>::const_iterator sumIt = bestDecreasingSumInDimensionIt; sumIt != sumsInDimension.end(); ++sumIt)
+	{
+	  if (*sumIt < 0)
+	    {
+	      optimisticIncreaseInDimension -= *sumIt;
+	      ++nbOfRemovableElements;
+	    }
+	  if (*sumIt < *bestDecreasingSumInDimensionIt) // in case of equality, prefer removing the globally sparsest slice
+	    {
+	      bestDecreasingSumInDimensionIt = sumIt;
+	    }
+	}
       if (dimensionIt->size() != 1)
 	{
 	  // Any element can be erased from *dimensionIt
-	  const vector<int>::const_iterator bestDecreasingSumInDimensionIt = min_element(sumsInDimension.begin(), sumsInDimension.end()); // in case of equality, prefer removing the globally sparsest slice
 	  double g = membershipSum - *bestDecreasingSumInDimensionIt;
 	  g *= abs(g) / (area / dimensionIt->size() * (dimensionIt->size() - 1));
 	  if (g > bestG)
@@ -215,6 +410,8 @@ void ModifiedPattern::considerDimensionForNextModificationStep(const vector<vect
 	      nextStep = erase;
 	    }
 	}
+      optimisticIncrease += optimisticIncreaseInDimension;
+      optimisticArea *= max(dimensionIt->size() - nbOfRemovableElements, static_cast<size_t>(1));
       return;
     }
   // Some element absent from *dimensionIt can be added
@@ -223,17 +420,29 @@ void ModifiedPattern::considerDimensionForNextModificationStep(const vector<vect
   if (dimensionIt->size() == 1)
     {
       // No element can be erased from *dimensionIt
-      if (dimensionIt->front())
+      sumIt = sumsInDimension.begin();
+      bestIncreasingSumInDimensionIt = sumIt;
+      for (const vector<int>::const_iterator end = sumIt + dimensionIt->front(); sumIt != end; ++sumIt)
 	{
-	  sumIt = sumsInDimension.begin() + dimensionIt->front();
-	  bestIncreasingSumInDimensionIt = max_element(sumsInDimension.begin(), sumIt, [](const int sum1, const int sum2) {return sum1 <= sum2;}); // in case of equality, prefer adding the globally densest slice
-	  ++sumIt;
+	  optimisticIncreaseInDimension += max(*sumIt, 0);
+	  if (*sumIt >= *bestIncreasingSumInDimensionIt) // in case of equality, prefer adding the globally densest slice
+	    {
+	      bestIncreasingSumInDimensionIt = sumIt;
+	    }
 	}
-      else
+      // The present element
+      if (*sumIt < 0)
+	{
+	  optimisticIncreaseInDimension -= *sumIt;
+	  ++nbOfRemovableElements;
+	}
+      if (!dimensionIt->front())
 	{
-	  sumIt = ++(sumsInDimension.begin());
-	  bestIncreasingSumInDimensionIt = sumIt++;
+	  // Initializing bestIncreasingSumInDimensionIt with the sum relating to the first absent element
+	  bestIncreasingSumInDimensionIt = ++sumIt;
+	  optimisticIncreaseInDimension += max(*sumIt, 0);
 	}
+      ++sumIt;
     }
   else
     {
@@ -244,8 +453,21 @@ void ModifiedPattern::considerDimensionForNextModificationStep(const vector<vect
       if (*presentElementIdIt)
 	{
 	  // Initializing bestDecreasingSumInDimensionIt with the sum relating to the first present element; bestIncreasingSumInDimensionIt with the greatest sum before
-	  sumIt = sumBegin + *presentElementIdIt++;
-	  bestIncreasingSumInDimensionIt = max_element(sumBegin, sumIt, [](const int sum1, const int sum2) {return sum1 <= sum2;}); // in case of equality, prefer adding the globally densest slice
+	  bestIncreasingSumInDimensionIt = sumBegin;
+	  for (sumIt = sumBegin; sumIt != sumBegin + *presentElementIdIt; ++sumIt)
+	    {
+	      optimisticIncreaseInDimension += max(*sumIt, 0);
+	      if (*sumIt >= *bestIncreasingSumInDimensionIt) // in case of equality, prefer adding the globally densest slice
+		{
+		  bestIncreasingSumInDimensionIt = sumIt;
+		}
+	    }
+	  ++presentElementIdIt;
+	  if (*sumIt < 0)
+	    {
+	      optimisticIncreaseInDimension -= *sumIt;
+	      ++nbOfRemovableElements;
+	    }
 	  bestDecreasingSumInDimensionIt = sumIt++;
 	}
       else
@@ -253,26 +475,43 @@ void ModifiedPattern::considerDimensionForNextModificationStep(const vector<vect
 	  // Initializing bestIncreasingSumInDimensionIt with the sum relating to the first absent element; bestDecreasingSumInDimensionIt with the lowest sum before
 	  bestDecreasingSumInDimensionIt = sumBegin;
 	  sumIt = sumBegin;
+	  if (*sumIt < 0)
+	    {
+	      optimisticIncreaseInDimension -= *sumIt;
+	      ++nbOfRemovableElements;
+	    }
 	  unsigned int elementId = 1;
 	  for (const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end(); ++presentElementIdIt != presentElementIdEnd && *presentElementIdIt == elementId; ++elementId)
 	    {
-	      if (*++sumIt < *bestDecreasingSumInDimensionIt) // in case of equality, prefer removing the globally sparsest slice
+	      if (*++sumIt < 0)
+		{
+		  optimisticIncreaseInDimension -= *sumIt;
+		  ++nbOfRemovableElements;
+		}
+	      if (*sumIt < *bestDecreasingSumInDimensionIt) // in case of equality, prefer removing the globally sparsest slice
 		{
 		  bestDecreasingSumInDimensionIt = sumIt;
 		}
 	    }
 	  bestIncreasingSumInDimensionIt = ++sumIt++;
+	  optimisticIncreaseInDimension += max(*bestIncreasingSumInDimensionIt, 0);
 	}
       // Compute bestDecreasingSumInDimensionIt and bestIncreasingSumInDimensionIt considering the sums until the one relating to the last present element
       for (const vector<unsigned int>::const_iterator presentElementIdEnd = dimensionIt->end(); presentElementIdIt != presentElementIdEnd; ++presentElementIdIt)
 	{
 	  for (const vector<int>::const_iterator end = sumBegin + *presentElementIdIt; sumIt != end; ++sumIt)
 	    {
+	      optimisticIncreaseInDimension += max(*sumIt, 0);
 	      if (*sumIt >= *bestIncreasingSumInDimensionIt) // in case of equality, prefer adding the globally densest slice
 		{
 		  bestIncreasingSumInDimensionIt = sumIt;
 		}
 	    }
+	  if (*sumIt < 0)
+	    {
+	      optimisticIncreaseInDimension -= *sumIt;
+	      ++nbOfRemovableElements;
+	    }
 	  if (*sumIt < *bestDecreasingSumInDimensionIt) // in case of equality, prefer removing the globally sparsest slice
 	    {
 	      bestDecreasingSumInDimensionIt = sumIt;
@@ -292,11 +531,14 @@ void ModifiedPattern::considerDimensionForNextModificationStep(const vector<vect
   // Elements after the last present one
   for (const vector<int>::const_iterator sumEnd = sumsInDimension.end(); sumIt != sumEnd; ++sumIt)
     {
+      optimisticIncreaseInDimension += max(*sumIt, 0);
       if (*sumIt >= *bestIncreasingSumInDimensionIt) // in case of equality, prefer adding the globally densest slice
 	{
 	  bestIncreasingSumInDimensionIt = sumIt;
 	}
     }
+  optimisticIncrease += optimisticIncreaseInDimension;
+  optimisticArea *= max(dimensionIt->size() - nbOfRemovableElements, static_cast<size_t>(1));
   double g = membershipSum + *bestIncreasingSumInDimensionIt;
   g *= abs(g) / (area / dimensionIt->size() * (dimensionIt->size() + 1));
   if (g > bestG)
@@ -423,6 +665,42 @@ void ModifiedPattern::considerDimensionForNextGrowingStep(const vector<vector<un
     }
 }
 
+bool ModifiedPattern::isHopeless() const
+{
+  const double threshold = hopelessThreshold.load(memory_order_relaxed);
+  if (threshold == numeric_limits<double>::lowest())
+    {
+      // Fewer than nbOfBestGs local maxima found so far
+      return false;
+    }
+  // Heuristic, not a bound: ignoring how the slices interact, the membership sum of the patterns the climb reaches is estimated to be at most optimisticMembershipSum and their areas at least optimisticArea; also, every membership being at most unit, g = membershipSum * density is at most optimisticMembershipSum * unit, however small the area
+  const long long optimisticMembershipSum = membershipSum + optimisticIncrease;
+  if (optimisticMembershipSum <= 0)
+    {
+      return threshold > 0;
+    }
+  return min(static_cast<double>(optimisticMembershipSum) * AbstractRoughTensor::getUnit(), static_cast<double>(optimisticMembershipSum) * optimisticMembershipSum / optimisticArea) < threshold;
+}
+
+void ModifiedPattern::recordLocalMaximum() const
+{
+  // Under option --forget, a local maximum reached several times is recorded several times, what only makes the pruning more aggressive
+  const double g = static_cast<double>(membershipSum) * abs(membershipSum) / area;
+  if (g > hopelessThreshold.load(memory_order_relaxed))
+    {
+      const lock_guard<mutex> lock(bestGsLock);
+      bestGs.push(g);
+      if (bestGs.size() > nbOfBestGs)
+	{
+	  bestGs.pop();
+	}
+      if (bestGs.size() == nbOfBestGs)
+	{
+	  hopelessThreshold.store(bestGs.top(), memory_order_relaxed);
+	}
+    }
+}
+
 bool ModifiedPattern::doStep()
 {
   if (nextStep == stop)
@@ -432,43 +710,40 @@ bool ModifiedPattern::doStep()
       roughTensor->printPattern(nSet, static_cast<float>(membershipSum) / area, cout);
       cout << " locally maximizes g\n";
 #endif
-      if (isEveryVisitedPatternStored)
+      if (nbOfBestGs)
 	{
-	  if (AbstractRoughTensor::isDirectOutput())
-	    {
-	      const lock_guard<mutex> lock(candidateVariablesLock);
-	      roughTensor->output(std::move(nSet), static_cast<float>(membershipSum) / area);
-	      ++nbOfOutputPatterns;
-	      return false;
-	    }
-	  candidateVariables.emplace_back(std::move(nSet));
-	  return false;
+	  recordLocalMaximum();
 	}
       if (AbstractRoughTensor::isDirectOutput())
 	{
-	  candidateVariablesLock.lock();
-	  if (distinctCandidateVariables.insert(nSet).second)
+	  if (!isEveryVisitedPatternStored)
 	    {
-	      // Unlock candidateVariablesLock and lock another mutex, so that other local maxima can be tested (and were probably alreaady found: the above test fails) while that local maximum is output
-	      candidateVariablesLock.unlock();
-	      static mutex outputLock; // using a local mutex takes a little more time, but there are only a few distinct candidate variables and having a static member variable just for that case (!isEveryVisitedPatternStored && AbstractRoughTensor::isDirectOutput()) looks exagerated
-	      const lock_guard<mutex> lock(outputLock);
-	      roughTensor->output(std::move(nSet), static_cast<float>(membershipSum) / area);
-	      ++nbOfOutputPatterns;
+	      // Only the thread that first reaches the local maximum outputs it
+	      OutputFingerprints& shard = outputFingerprints[fingerprint.getEnd() % nbOfOutputFingerprintShards];
+	      const lock_guard<mutex> lock(shard.lock);
+	      if (!shard.fingerprints.insert(fingerprint).second)
+		{
+		  return false;
+		}
 	    }
-	  else
+	  patternsToOutput.emplace_back(nSet, static_cast<float>(membershipSum) / area);
+	  if (patternsToOutput.size() == nbOfPatternsPerOutput)
 	    {
-	      candidateVariablesLock.unlock();
+	      flushPatternsToOutput();
 	    }
 	  return false;
 	}
-      const lock_guard<mutex> lock(candidateVariablesLock);
-      distinctCandidateVariables.insert(std::move(nSet));
+      if (isEveryVisitedPatternStored)
+	{
+	  candidateVariables.emplace_back(nSet);
+	  return false;
+	}
+      distinctCandidateVariablesOfThread.try_emplace(fingerprint, nSet);
       return false;
     }
   area /= bestDimensionIt->size();
 #ifdef UPDATE_SUMS
-  vector<unsigned int> singleElement {static_cast<unsigned int>(bestSumIt - sumsOnHyperplanes[bestDimensionIt - nSet.begin()].begin())};
+  singleElement.front() = bestSumIt - sumsOnHyperplanes[bestDimensionIt - nSet.begin()].begin();
   const unsigned int element = singleElement.front();
 #else
   const unsigned int element = static_cast<unsigned int>(bestSumIt - sumsOnHyperplanes[bestDimensionIt - nSet.begin()].begin());
@@ -481,8 +756,10 @@ bool ModifiedPattern::doStep()
       cout << " gives ";
 #endif
       bestDimensionIt->insert(lower_bound(bestDimensionIt->begin(), bestDimensionIt->end(), element), element);
-      if (isEveryVisitedPatternStored && VisitedPatterns::visited(nSet))
+      fingerprint.toggle(bestDimensionIt - nSet.begin(), element);
+      if (isEveryVisitedPatternStored && isVisited())
 	{
+	  ++nbOfPrunedClimbs;
 #ifdef DEBUG_MODIFY
 	  roughTensor->printPattern(nSet, static_cast<float>(membershipSum + *bestSumIt) / (area * bestDimensionIt->size()), cout);
 	  cout << ", which has already been reached: abort\n";
@@ -493,11 +770,25 @@ bool ModifiedPattern::doStep()
       singleElement.swap(*bestDimensionIt);
       if (Trie::is01)
 	{
-	  tensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	  if (isTensorFlat)
+	    {
+	      flatTensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	    }
+	  else
+	    {
+	      tensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	    }
 	}
       else
 	{
-	  tensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes);
+	  if (isTensorFlat)
+	    {
+	      flatTensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes);
+	    }
+	  else
+	    {
+	      tensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes);
+	    }
 	}
       membershipSum += *bestSumIt;
 #endif
@@ -510,8 +801,10 @@ bool ModifiedPattern::doStep()
       cout << " gives ";
 #endif
       bestDimensionIt->erase(lower_bound(bestDimensionIt->begin(), bestDimensionIt->end(), element));
-      if (isEveryVisitedPatternStored && VisitedPatterns::visited(nSet))
+      fingerprint.toggle(bestDimensionIt - nSet.begin(), element);
+      if (isEveryVisitedPatternStored && isVisited())
 	{
+	  ++nbOfPrunedClimbs;
 #ifdef DEBUG_MODIFY
 	  roughTensor->printPattern(nSet, static_cast<float>(membershipSum - *bestSumIt) / (area * bestDimensionIt->size()), cout);
 	  cout << ", which has already been reached: abort\n";
@@ -522,11 +815,25 @@ bool ModifiedPattern::doStep()
       singleElement.swap(*bestDimensionIt);
       if (Trie::is01)
 	{
-	  tensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes, -area, -AbstractRoughTensor::getUnit()); // negating the last two arguments for a decrease
+	  if (isTensorFlat)
+	    {
+	      flatTensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes, -area, -AbstractRoughTensor::getUnit()); // negating the last two arguments for a decrease
+	    }
+	  else
+	    {
+	      tensor.increaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes, -area, -AbstractRoughTensor::getUnit()); // negating the last two arguments for a decrease
+	    }
 	}
       else
 	{
-	  tensor.decreaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes);
+	  if (isTensorFlat)
+	    {
+	      flatTensor.decreaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes);
+	    }
+	  else
+	    {
+	      tensor.decreaseSumsOnHyperplanes(nSet.begin(), bestDimensionIt - nSet.begin(), sumsOnHyperplanes);
+	    }
 	}
       membershipSum -= *bestSumIt;
 #endif
@@ -538,11 +845,25 @@ bool ModifiedPattern::doStep()
   area *= bestDimensionIt->size();
   if (Trie::is01)
     {
-      membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+      if (isTensorFlat)
+	{
+	  membershipSum = flatTensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	}
+      else
+	{
+	  membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	}
     }
   else
     {
-      membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes);
+      if (isTensorFlat)
+	{
+	  membershipSum = flatTensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes);
+	}
+      else
+	{
+	  membershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), sumsOnHyperplanes);
+	}
     }
 #endif
 #ifdef DEBUG_MODIFY
@@ -552,16 +873,49 @@ bool ModifiedPattern::doStep()
   return true;
 }
 
-void ModifiedPattern::setContext(const AbstractRoughTensor* roughTensorParam, const bool isEveryVisitedPatternStoredParam)
+void ModifiedPattern::flushPatternsToOutput()
+{
+  if (patternsToOutput.empty())
+    {
+      return;
+    }
+  {
+    const lock_guard<mutex> lock(outputLock);
+    for (const pair<vector<vector<unsigned int>>, float>& patternToOutput : patternsToOutput)
+      {
+	roughTensor->output(patternToOutput.first, patternToOutput.second);
+      }
+    nbOfOutputPatterns += patternsToOutput.size();
+  }
+  patternsToOutput.clear();
+}
+
+void ModifiedPattern::setHopelessClimbsPruning(const unsigned int nbOfBestGsParam)
+{
+  nbOfBestGs = nbOfBestGsParam;
+}
+
+void ModifiedPattern::setContext(const AbstractRoughTensor* roughTensorParam, const bool isEveryVisitedPatternStoredParam, const unsigned long long visitedPatternsMemory, const bool isVisitedPatternsFiltered, const bool isTensorFlatParam)
 {
   nbOfOutputPatterns = 0;
   roughTensor = roughTensorParam;
-  tensor = roughTensor->getTensor();
+  isTensorFlat = isTensorFlatParam;
+  if (isTensorFlat)
+    {
+      flatTensor = FlatTrie(roughTensor->getTensor(), AbstractRoughTensor::getCardinalities());
+    }
+  else
+    {
+      tensor = roughTensor->getTensor();
+    }
+  NSetFingerprint::init(AbstractRoughTensor::getCardinalities());
   isEveryVisitedPatternStored = isEveryVisitedPatternStoredParam;
   if (isEveryVisitedPatternStored)
     {
-      VisitedPatterns::init(AbstractRoughTensor::getCardinalities());
+      VisitedPatterns::init(AbstractRoughTensor::getCardinalities(), visitedPatternsMemory, isVisitedPatternsFiltered);
+      return;
     }
+  outputFingerprints = vector<OutputFingerprints>(nbOfOutputFingerprintShards);
 }
 
 #ifdef ASSERT
@@ -600,11 +954,25 @@ void ModifiedPattern::assertAreaAndSums()
     while (++cardinalityIt != cardinalityEnd);
     if (Trie::is01)
       {
-	actualMembershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), actualSumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	if (isTensorFlat)
+	  {
+	    actualMembershipSum = flatTensor.sumsOnPatternAndHyperplanes(nSet.begin(), actualSumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	  }
+	else
+	  {
+	    actualMembershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), actualSumsOnHyperplanes, area, AbstractRoughTensor::getUnit());
+	  }
       }
     else
       {
-	actualMembershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), actualSumsOnHyperplanes);
+	if (isTensorFlat)
+	  {
+	    actualMembershipSum = flatTensor.sumsOnPatternAndHyperplanes(nSet.begin(), actualSumsOnHyperplanes);
+	  }
+	else
+	  {
+	    actualMembershipSum = tensor.sumsOnPatternAndHyperplanes(nSet.begin(), actualSumsOnHyperplanes);
+	  }
       }
     if (actualMembershipSum != membershipSum)
       {
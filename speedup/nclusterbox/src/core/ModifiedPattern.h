@@ -11,11 +11,16 @@
 #ifndef MODIFIED_PATTERN_H_
 #define MODIFIED_PATTERN_H_
 
+#include <unordered_map>
 #include <unordered_set>
 #include <mutex>
-#include <boost/container_hash/hash.hpp>
+#include <atomic>
+#include <queue>
 
 #include "AbstractRoughTensor.h"
+#include "FlatTrie.h"
+#include "NSetFingerprint.h"
+#include "AllocationCounter.h"
 
 enum NextStep { insert, erase, stop };
 
@@ -25,12 +30,31 @@ class ModifiedPattern
   static void modify();
   static void grow();
 
-  static void setContext(const AbstractRoughTensor* roughTensor, const bool isEveryVisitedPatternStored);
+  static void setContext(const AbstractRoughTensor* roughTensor, const bool isEveryVisitedPatternStored, const unsigned long long visitedPatternsMemory, const bool isVisitedPatternsFiltered, const bool isTensorFlat);
   static unsigned int getNbOfOutputPatterns();
+  static void setHopelessClimbsPruning(const unsigned int nbOfBestGs); // 0 (default) never abandons a climb
+  static unsigned long long getNbOfPrunedClimbs(); // because reaching an already visited pattern
+  static unsigned long long getNbOfHopelessClimbs();
+  static double getAverageNbOfStepsInHopelessClimbs();
+  static double getAverageNbOfStepsInCompleteClimbs();
+#ifdef NB_OF_ALLOCATIONS
+  static double getNbOfAllocationsPerInitialPattern();
+#endif
   static void insertCandidateVariables();
 
  private:
+  struct alignas(64) OutputFingerprints
+  {
+    mutex lock;
+    unordered_set<NSetFingerprint, NSetFingerprint::Hash> fingerprints;
+
+    OutputFingerprints();
+  };
+
+  vector<vector<vector<unsigned int>>> initialPatterns; // the last batch taken from ConcurrentPatternPool
+  vector<vector<vector<unsigned int>>>::const_iterator nextInitialPatternIt;
   vector<vector<unsigned int>> nSet;
+  NSetFingerprint fingerprint; // of nSet, updated at every step
   unsigned long long area;
   long long membershipSum;
   vector<vector<int>> sumsOnHyperplanes;
@@ -39,27 +63,62 @@ class ModifiedPattern
   double bestG;
   vector<vector<unsigned int>>::iterator bestDimensionIt;
   vector<int>::const_iterator bestSumIt;
-
-  // if isEveryVisitedPatternStored && AbstractRoughTensor::isDirectOutput(), no container below is used, otherwise one single is used
+  vector<unsigned int> singleElement; // swapped with the modified dimension to update sumsOnHyperplanes (#ifdef UPDATE_SUMS)
+  long long optimisticIncrease; // computed with the next step, see considerDimensionForNextModificationStep
+  double optimisticArea; // product, over the dimensions, of the numbers of present elements whose slices do not have negative sums (at least one)
+  unsigned int nbOfStepsInClimb;
+  unsigned long long nbOfStepsInCompleteClimbsOfThread;
+  unsigned long long nbOfCompleteClimbsOfThread;
+  unsigned long long nbOfStepsInHopelessClimbsOfThread;
+  unsigned long long nbOfHopelessClimbsOfThread;
+
+  // Local maxima of the thread, one single container below being used; they are moved to the static containers once, at destruction, or output by blocks
+  vector<pair<vector<vector<unsigned int>>, float>> patternsToOutput; // if AbstractRoughTensor::isDirectOutput(), with their densities
   vector<vector<vector<unsigned int>>> candidateVariables; // if isEveryVisitedPatternStored && !AbstractRoughTensor::isDirectOutput()
-  static unordered_set<vector<vector<unsigned int>>, boost::hash<vector<vector<unsigned int>>>> distinctCandidateVariables; // if !isEveryVisitedPatternStored
+  unordered_map<NSetFingerprint, vector<vector<unsigned int>>, NSetFingerprint::Hash> distinctCandidateVariablesOfThread; // if !isEveryVisitedPatternStored && !AbstractRoughTensor::isDirectOutput(), keyed by their fingerprints
+
+  static unordered_map<NSetFingerprint, vector<vector<unsigned int>>, NSetFingerprint::Hash> distinctCandidateVariables; // union of the distinctCandidateVariablesOfThread
+  static vector<OutputFingerprints> outputFingerprints; // if !isEveryVisitedPatternStored, shards of the fingerprints of the patterns directly output
 
   static unsigned int nbOfOutputPatterns;
+  static atomic<unsigned long long> nbOfPrunedClimbs;
+  static atomic<unsigned long long> nbOfStepsInCompleteClimbs;
+  static atomic<unsigned long long> nbOfCompleteClimbs;
+  static atomic<unsigned long long> nbOfStepsInHopelessClimbs;
+  static atomic<unsigned long long> nbOfHopelessClimbs;
   static mutex candidateVariablesLock;
+  static mutex outputLock;
+#ifdef NB_OF_ALLOCATIONS
+  static atomic<unsigned long long> nbOfInitialPatterns;
+  static atomic<unsigned long long> nbOfAllocations;
+#endif
+
+  // if nbOfBestGs, a climb is abandoned once a heuristic estimate of the explanatory power it can reach, which ignores how the slices interact (hence no bound), is below hopelessThreshold, the nbOfBestGs-th largest explanatory power of the local maxima found so far
+  static unsigned int nbOfBestGs;
+  static priority_queue<double, vector<double>, greater<double>> bestGs;
+  static atomic<double> hopelessThreshold;
+  static mutex bestGsLock;
 
   static const AbstractRoughTensor* roughTensor;
   static bool isEveryVisitedPatternStored;
+  static bool isTensorFlat;
   static Trie tensor;
+  static FlatTrie flatTensor;
 
   ModifiedPattern();
   ~ModifiedPattern();
 
   void doModify();
   void doGrow();
+  bool nextInitialPattern(); // moves the next initial pattern into nSet, returns false if there is none
+  bool isVisited() const;
   void init();
   void considerDimensionForNextModificationStep(const vector<vector<unsigned int>>::iterator dimensionIt, const vector<int>& sumsInDimension);
+  bool isHopeless() const;
+  void recordLocalMaximum() const; // updates hopelessThreshold
   void considerDimensionForNextGrowingStep(const vector<vector<unsigned int>>::iterator dimensionIt, const vector<int>& sumsInDimension, const vector<unsigned int>& firstNonInitialAndSubsequentInitial);
   bool doStep(); // returns whether to go on
+  void flushPatternsToOutput();
 
 #ifdef ASSERT
   void assertAreaAndSums();
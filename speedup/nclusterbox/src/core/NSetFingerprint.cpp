@@ -0,0 +1,83 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "NSetFingerprint.h"
+
+vector<unsigned int> NSetFingerprint::elementOffsets;
+
+// Finalizer of MurmurHash3: every bit of the input affects every bit of the output
+static unsigned long long mix(unsigned long long hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+size_t NSetFingerprint::Hash::operator()(const NSetFingerprint& fingerprint) const
+{
+  return fingerprint.begin;
+}
+
+void NSetFingerprint::init(const vector<unsigned int>& cardinalities)
+{
+  elementOffsets.clear();
+  elementOffsets.reserve(cardinalities.size());
+  unsigned int elementOffset = 0;
+  for (const unsigned int cardinality : cardinalities)
+    {
+      elementOffsets.push_back(elementOffset);
+      elementOffset += cardinality;
+    }
+}
+
+NSetFingerprint::NSetFingerprint(): begin(0), end(0)
+{
+}
+
+bool NSetFingerprint::operator==(const NSetFingerprint& otherFingerprint) const
+{
+  return begin == otherFingerprint.begin && end == otherFingerprint.end;
+}
+
+unsigned long long NSetFingerprint::getBegin() const
+{
+  return begin;
+}
+
+unsigned long long NSetFingerprint::getEnd() const
+{
+  return end;
+}
+
+void NSetFingerprint::set(const vector<vector<unsigned int>>& nSet)
+{
+  begin = 0;
+  end = 0;
+  unsigned int dimensionId = 0;
+  for (const vector<unsigned int>& dimension : nSet)
+    {
+      for (const unsigned int elementId : dimension)
+	{
+	  toggle(dimensionId, elementId);
+	}
+      ++dimensionId;
+    }
+}
+
+void NSetFingerprint::toggle(const unsigned int dimensionId, const unsigned int elementId)
+{
+  // The two keys of the element are hashes of two distinct odd multiples of its global id plus one
+  const unsigned long long globalId = elementOffsets[dimensionId] + elementId + 1;
+  begin ^= mix(globalId * 0x9e3779b97f4a7c15ULL);
+  end ^= mix(globalId * 0xc2b2ae3d27d4eb4fULL);
+}
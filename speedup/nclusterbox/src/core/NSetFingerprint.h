@@ -0,0 +1,47 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef N_SET_FINGERPRINT_H_
+#define N_SET_FINGERPRINT_H_
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/* Zobrist-style 128-bit fingerprint of an n-set: the exclusive or of the keys of its elements, every key being a hash of the element; adding or removing an element toggles its key in O(1) */
+class NSetFingerprint
+{
+ public:
+  struct Hash
+  {
+    size_t operator()(const NSetFingerprint& fingerprint) const;
+  };
+
+  static void init(const vector<unsigned int>& cardinalities);
+
+  NSetFingerprint();
+
+  bool operator==(const NSetFingerprint& otherFingerprint) const;
+
+  unsigned long long getBegin() const;
+  unsigned long long getEnd() const;
+
+  void set(const vector<vector<unsigned int>>& nSet);
+  void toggle(const unsigned int dimensionId, const unsigned int elementId);
+
+ private:
+  static vector<unsigned int> elementOffsets; /* elementOffsets[dimensionId] is the sum of the cardinalities of the previous dimensions */
+
+  unsigned long long begin;
+  unsigned long long end;
+};
+
+#endif /*N_SET_FINGERPRINT_H_*/
@@ -11,6 +11,8 @@
 #include "PatternFileReader.h"
 
 #include <iostream>
+#include <limits>
+#include <cstdlib>
 #include <boost/lexical_cast.hpp>
 
 #include "../utilities/NoInputException.h"
@@ -21,9 +23,18 @@
 string PatternFileReader::noisyNSetFileName;
 istream PatternFileReader::noisyNSetStream(nullptr);
 ifstream PatternFileReader::noisyNSetFile;
-vector<unordered_map<string, unsigned int>> PatternFileReader::labels2Ids;
+DecompressingStreamBuffer* PatternFileReader::decompressingStreamBuffer = nullptr;
+char_separator<char> PatternFileReader::inputDimensionSeparator;
 char_separator<char> PatternFileReader::inputElementSeparator;
-unsigned int PatternFileReader::lineNb;
+unsigned int PatternFileReader::lineNb = 0;
+vector<unordered_map<string, unsigned int>> PatternFileReader::labels2LocalIds;
+vector<vector<string>> PatternFileReader::localIds2Labels;
+vector<vector<unsigned int>> PatternFileReader::localIds2Ids;
+vector<unordered_map<string, unsigned int>> PatternFileReader::labels2Ids;
+vector<pair<unsigned int, vector<vector<unsigned int>>>> PatternFileReader::tokenizedNSets;
+string PatternFileReader::tokenizingErrorMessage;
+atomic<bool> PatternFileReader::isTensorLoaded(false);
+thread PatternFileReader::tokenizingThread;
 
 unordered_map<string, unsigned int> labels2IdsInDimension(const vector<string>& labelsInDimension)
 {
@@ -40,27 +51,74 @@ unordered_map<string, unsigned int> labels2IdsInDimension(const vector<string>&
   return labels2Ids;
 }
 
-void PatternFileReader::openFile(const char* noisyNSetFileNameParam)
+void PatternFileReader::openFile(const char* noisyNSetFileNameParam, const char* inputDimensionSeparatorParam, const char* inputElementSeparatorParam, const unsigned long long maxNbOfInitialPatterns)
 {
   ConcurrentPatternPool::setReadFromFile();
   noisyNSetFileName = noisyNSetFileNameParam;
-  if (noisyNSetFileName == "-")
+  inputDimensionSeparator = char_separator<char>(inputDimensionSeparatorParam);
+  inputElementSeparator = char_separator<char>(inputElementSeparatorParam);
+  decompressingStreamBuffer = DecompressingStreamBuffer::open(noisyNSetFileNameParam);
+  if (decompressingStreamBuffer)
     {
-      noisyNSetStream.rdbuf(cin.rdbuf());
-      return;
+      noisyNSetStream.rdbuf(decompressingStreamBuffer);
+      // Have the stream rethrow the NoInputException of a corrupted compressed file
+      noisyNSetStream.exceptions(ios::badbit);
     }
-  noisyNSetFile.open(noisyNSetFileNameParam);
-  if (!noisyNSetFile)
+  else
     {
-      throw NoInputException(noisyNSetFileNameParam);
+      if (noisyNSetFileName == "-")
+	{
+	  noisyNSetStream.rdbuf(cin.rdbuf());
+	}
+      else
+	{
+	  noisyNSetFile.open(noisyNSetFileNameParam);
+	  if (!noisyNSetFile)
+	    {
+	      throw NoInputException(noisyNSetFileNameParam);
+	    }
+	  noisyNSetStream.rdbuf(noisyNSetFile.rdbuf());
+	}
     }
-  noisyNSetStream.rdbuf(noisyNSetFile.rdbuf());
+#ifndef VERBOSE_PARSER
+  // Printing the patterns in the middle of the tensor would be confusing
+  tokenizingThread = thread(tokenizeAhead, maxNbOfInitialPatterns);
+  atexit(stopTokenizingAhead);
+#endif
 }
 
-void PatternFileReader::read(const char* inputDimensionSeparatorParam, const char* inputElementSeparatorParam, const vector<vector<string>>& ids2Labels, unsigned long long maxNbOfInitialPatterns)
+void PatternFileReader::tokenizeAhead(const unsigned long long maxNbOfNSets)
 {
-  inputElementSeparator = char_separator<char>(inputElementSeparatorParam);
-  lineNb = 0;
+  try
+    {
+      vector<vector<unsigned int>> tokenizedNSet;
+      for (unsigned long long nbOfNSetsToTokenize = maxNbOfNSets; !isTensorLoaded.load(memory_order_relaxed) && getTokenizedNSet(tokenizedNSet); )
+	{
+	  tokenizedNSets.emplace_back(lineNb, std::move(tokenizedNSet));
+	  if (!--nbOfNSetsToTokenize)
+	    {
+	      break;
+	    }
+	}
+    }
+  catch (NoInputException& e)
+    {
+      tokenizingErrorMessage = e.what();
+    }
+}
+
+void PatternFileReader::stopTokenizingAhead()
+{
+  isTensorLoaded.store(true, memory_order_relaxed);
+  if (tokenizingThread.joinable())
+    {
+      tokenizingThread.join();
+    }
+}
+
+void PatternFileReader::read(const vector<vector<string>>& ids2Labels, unsigned long long maxNbOfInitialPatterns)
+{
+  stopTokenizingAhead();
   vector<vector<string>>::const_iterator labelsInDimensionIt = ids2Labels.begin();
   const vector<vector<string>>::const_iterator labelsInDimensionEnd = ids2Labels.end();
   labels2Ids.reserve(labelsInDimensionEnd - labelsInDimensionIt);
@@ -71,7 +129,67 @@ void PatternFileReader::read(const char* inputDimensionSeparatorParam, const cha
       labels2Ids.emplace_back(labels2IdsInDimension(*labelsInDimensionIt));
     }
   while (++labelsInDimensionIt != labelsInDimensionEnd);
-  const char_separator<char> inputDimensionSeparator(inputDimensionSeparatorParam);
+  localIds2Ids.resize(labels2Ids.size());
+  // Patterns tokenized ahead
+  const unsigned int nbOfTokenizedLines = lineNb;
+  bool isMaxReached = false;
+  for (vector<pair<unsigned int, vector<vector<unsigned int>>>>::const_iterator tokenizedNSetIt = tokenizedNSets.begin(); !isMaxReached && tokenizedNSetIt != tokenizedNSets.end(); ++tokenizedNSetIt)
+    {
+      lineNb = tokenizedNSetIt->first;
+      isMaxReached = addPattern(tokenizedNSetIt->second) && !--maxNbOfInitialPatterns;
+    }
+  if (!isMaxReached)
+    {
+      if (tokenizingErrorMessage.empty())
+	{
+	  // Subsequent patterns
+	  lineNb = nbOfTokenizedLines;
+	  vector<vector<unsigned int>> tokenizedNSet;
+	  for (; ; )
+	    {
+	      try
+		{
+		  if (!getTokenizedNSet(tokenizedNSet))
+		    {
+		      break;
+		    }
+		}
+	      catch (NoInputException& e)
+		{
+		  cerr << e.what() << " -> subsequent patterns ignored!\n";
+		  break;
+		}
+	      if (addPattern(tokenizedNSet) && !--maxNbOfInitialPatterns)
+		{
+		  break;
+		}
+	    }
+	}
+      else
+	{
+	  cerr << tokenizingErrorMessage << " -> subsequent patterns ignored!\n";
+	}
+    }
+  ConcurrentPatternPool::allPatternsAdded();
+  noisyNSetFile.close();
+  delete decompressingStreamBuffer;
+  decompressingStreamBuffer = nullptr;
+  noisyNSetFileName.clear();
+  noisyNSetFileName.shrink_to_fit();
+  labels2LocalIds.clear();
+  labels2LocalIds.shrink_to_fit();
+  localIds2Labels.clear();
+  localIds2Labels.shrink_to_fit();
+  localIds2Ids.clear();
+  localIds2Ids.shrink_to_fit();
+  labels2Ids.clear();
+  labels2Ids.shrink_to_fit();
+  tokenizedNSets.clear();
+  tokenizedNSets.shrink_to_fit();
+}
+
+bool PatternFileReader::getTokenizedNSet(vector<vector<unsigned int>>& tokenizedNSet)
+{
   while (!noisyNSetStream.eof())
     {
       ++lineNb;
@@ -83,68 +201,112 @@ void PatternFileReader::read(const char* inputDimensionSeparatorParam, const cha
 #ifdef VERBOSE_PARSER
 	  cout << noisyNSetFileName << ':' << lineNb << ": " << noisyNSetString << '\n';
 #endif
-	  const tokenizer<char_separator<char>>::const_iterator dimensionEnd = dimensions.end();
-	  tokenizer<char_separator<char>>::const_iterator dimensionIt = dimensions.begin();
-	  vector<vector<unsigned int>> nSet(labels2Ids.size());
-	  vector<unordered_map<string, unsigned int>>::const_iterator labels2IdsIt = labels2Ids.begin();
-	  try
+	  vector<vector<unsigned int>>::iterator tokenizedDimensionIt = tokenizedNSet.begin();
+	  vector<unordered_map<string, unsigned int>>::iterator labels2LocalIdsIt = labels2LocalIds.begin();
+	  vector<vector<string>>::iterator localIds2LabelsIt = localIds2Labels.begin();
+	  for (const string& dimension : dimensions)
 	    {
-	      vector<unsigned int>::const_iterator internalDimensionIdIt = AbstractRoughTensor::getExternal2InternalDimensionOrder().begin();
-	      nSet[*internalDimensionIdIt] = getDimension(dimensionIt, dimensionEnd, labels2IdsIt);
-	      ++internalDimensionIdIt;
-	      const vector<unsigned int>::const_iterator internalDimensionIdEnd = AbstractRoughTensor::getExternal2InternalDimensionOrder().end();
-	      do
+	      if (labels2LocalIdsIt == labels2LocalIds.end())
 		{
-		  nSet[*internalDimensionIdIt] = getDimension(++dimensionIt, dimensionEnd, ++labels2IdsIt);
+		  labels2LocalIds.emplace_back();
+		  labels2LocalIdsIt = labels2LocalIds.end() - 1;
+		  localIds2Labels.emplace_back();
+		  localIds2LabelsIt = localIds2Labels.end() - 1;
 		}
-	      while (++internalDimensionIdIt != internalDimensionIdEnd);
-	    }
-	  catch (DataFormatException& e)
-	    {
-	      cerr << e.what() << " -> pattern ignored!\n";
-	      continue;
-	    }
-	  ConcurrentPatternPool::addPattern(nSet);
-	  if (!--maxNbOfInitialPatterns)
-	    {
-	      break;
+	      if (tokenizedDimensionIt == tokenizedNSet.end())
+		{
+		  tokenizedNSet.emplace_back();
+		  tokenizedDimensionIt = tokenizedNSet.end() - 1;
+		}
+	      vector<unsigned int>& tokenizedDimension = *tokenizedDimensionIt++;
+	      tokenizedDimension.clear();
+	      tokenizer<char_separator<char>> elements(dimension, inputElementSeparator);
+	      for (const string& element : elements)
+		{
+		  const unordered_map<string, unsigned int>::const_iterator label2LocalIdIt = labels2LocalIdsIt->find(element);
+		  if (label2LocalIdIt == labels2LocalIdsIt->end())
+		    {
+		      tokenizedDimension.push_back(localIds2LabelsIt->size());
+		      labels2LocalIdsIt->emplace(element, localIds2LabelsIt->size());
+		      localIds2LabelsIt->push_back(element);
+		    }
+		  else
+		    {
+		      tokenizedDimension.push_back(label2LocalIdIt->second);
+		    }
+		}
+	      ++labels2LocalIdsIt;
+	      ++localIds2LabelsIt;
 	    }
+	  tokenizedNSet.erase(tokenizedDimensionIt, tokenizedNSet.end());
+	  return true;
 	}
     }
-  ConcurrentPatternPool::allPatternsAdded();
-  noisyNSetFile.close();
-  noisyNSetFileName.clear();
-  noisyNSetFileName.shrink_to_fit();
-  labels2Ids.clear();
-  labels2Ids.shrink_to_fit();
+  return false;
 }
 
-vector<unsigned int> PatternFileReader::getDimension(const tokenizer<char_separator<char>>::const_iterator dimensionIt, const tokenizer<char_separator<char>>::const_iterator dimensionEnd, const vector<unordered_map<string, unsigned int>>::const_iterator labels2IdsIt)
+bool PatternFileReader::addPattern(const vector<vector<unsigned int>>& tokenizedNSet)
 {
-  if (dimensionIt == dimensionEnd)
+  vector<vector<unsigned int>> nSet(labels2Ids.size());
+  try
+    {
+      unsigned int dimensionId = 0;
+      for (const unsigned int internalDimensionId : AbstractRoughTensor::getExternal2InternalDimensionOrder())
+	{
+	  nSet[internalDimensionId] = getDimension(tokenizedNSet, dimensionId++);
+	}
+    }
+  catch (DataFormatException& e)
+    {
+      cerr << e.what() << " -> pattern ignored!\n";
+      return false;
+    }
+  ConcurrentPatternPool::addPattern(nSet);
+  return true;
+}
+
+vector<unsigned int> PatternFileReader::getDimension(const vector<vector<unsigned int>>& tokenizedNSet, const unsigned int dimensionId)
+{
+  if (dimensionId == tokenizedNSet.size())
     {
       throw DataFormatException(noisyNSetFileName.c_str(), lineNb, ("less than the expected " + lexical_cast<string>(labels2Ids.size()) + " dimensions").c_str());
     }
-  vector<unsigned int> nSetDimension;
-  const unordered_map<string, unsigned int>::const_iterator label2IdEnd = labels2IdsIt->end();
-  tokenizer<char_separator<char>> elements(*dimensionIt, inputElementSeparator);
-  for (const string& element : elements)
+  // Map the labels met since the last call to the tensor ids
+  vector<unsigned int>& localIds2IdsInDimension = localIds2Ids[dimensionId];
+  const unordered_map<string, unsigned int>& labels2IdsInDimension = labels2Ids[dimensionId];
+  const unordered_map<string, unsigned int>::const_iterator label2IdEnd = labels2IdsInDimension.end();
+  const vector<string>& localIds2LabelsInDimension = localIds2Labels[dimensionId];
+  for (vector<string>::const_iterator labelIt = localIds2LabelsInDimension.begin() + localIds2IdsInDimension.size(); labelIt != localIds2LabelsInDimension.end(); ++labelIt)
     {
-      const unordered_map<string, unsigned int>::const_iterator label2IdIt = labels2IdsIt->find(element);
+      const unordered_map<string, unsigned int>::const_iterator label2IdIt = labels2IdsInDimension.find(*labelIt);
       if (label2IdIt == label2IdEnd)
 	{
-	  throw DataFormatException(noisyNSetFileName.c_str(), lineNb, (element + " is not in dimension " + lexical_cast<string>(labels2IdsIt - labels2Ids.begin()) + " of fuzzy tensor").c_str());
+	  localIds2IdsInDimension.push_back(numeric_limits<unsigned int>::max());
+	}
+      else
+	{
+	  localIds2IdsInDimension.push_back(label2IdIt->second);
+	}
+    }
+  vector<unsigned int> nSetDimension;
+  nSetDimension.reserve(tokenizedNSet[dimensionId].size());
+  for (const unsigned int localId : tokenizedNSet[dimensionId])
+    {
+      const unsigned int id = localIds2IdsInDimension[localId];
+      if (id == numeric_limits<unsigned int>::max())
+	{
+	  throw DataFormatException(noisyNSetFileName.c_str(), lineNb, (localIds2LabelsInDimension[localId] + " is not in dimension " + lexical_cast<string>(dimensionId) + " of fuzzy tensor").c_str());
 	}
-      nSetDimension.push_back(label2IdIt->second);
+      nSetDimension.push_back(id);
     }
   if (nSetDimension.empty())
     {
-      throw DataFormatException(noisyNSetFileName.c_str(), lineNb, ("no element in dimension " + lexical_cast<string>(labels2IdsIt - labels2Ids.begin())).c_str());
+      throw DataFormatException(noisyNSetFileName.c_str(), lineNb, ("no element in dimension " + lexical_cast<string>(dimensionId)).c_str());
     }
   sort(nSetDimension.begin(), nSetDimension.end());
   if (adjacent_find(nSetDimension.begin(), nSetDimension.end()) != nSetDimension.end())
     {
-      throw DataFormatException(noisyNSetFileName.c_str(), lineNb, ("repeated elements in dimension " + lexical_cast<string>(labels2IdsIt - labels2Ids.begin())).c_str());
+      throw DataFormatException(noisyNSetFileName.c_str(), lineNb, ("repeated elements in dimension " + lexical_cast<string>(dimensionId)).c_str());
     }
   return nSetDimension;
 }
@@ -15,26 +15,43 @@
 #include <string>
 #include <unordered_map>
 #include <fstream>
+#include <thread>
+#include <atomic>
 #include <boost/tokenizer.hpp>
 
+#include "DecompressingStreamBuffer.h"
+
 using namespace std;
 using namespace boost;
 
 class PatternFileReader
 {
  public:
-  static void openFile(const char* noisyNSetFileName);
-  static void read(const char* inputDimensionSeparator, const char* inputElementSeparator, const vector<vector<string>>& ids2Labels, unsigned long long maxNbOfInitialPatterns);
+  static void openFile(const char* noisyNSetFileName, const char* inputDimensionSeparator, const char* inputElementSeparator, const unsigned long long maxNbOfInitialPatterns); /* starts tokenizing the patterns, in parallel with the loading of the tensor */
+  static void read(const vector<vector<string>>& ids2Labels, unsigned long long maxNbOfInitialPatterns);
 
  private:
   static string noisyNSetFileName;
   static istream noisyNSetStream;
   static ifstream noisyNSetFile;
-  static vector<unordered_map<string, unsigned int>> labels2Ids;
+  static DecompressingStreamBuffer* decompressingStreamBuffer; /* nullptr unless the pattern file is compressed or a pipe */
+  static char_separator<char> inputDimensionSeparator;
   static char_separator<char> inputElementSeparator;
   static unsigned int lineNb;
-
-  static vector<unsigned int> getDimension(const tokenizer<char_separator<char>>::const_iterator dimensionIt, const tokenizer<char_separator<char>>::const_iterator dimensionEnd, const vector<unordered_map<string, unsigned int>>::const_iterator labels2IdsIt);
+  static vector<unordered_map<string, unsigned int>> labels2LocalIds; /* per dimension of the pattern file, local ids in order of first appearance */
+  static vector<vector<string>> localIds2Labels;
+  static vector<vector<unsigned int>> localIds2Ids; /* numeric_limits<unsigned int>::max() for a label that is not in the tensor */
+  static vector<unordered_map<string, unsigned int>> labels2Ids;
+  static vector<pair<unsigned int, vector<vector<unsigned int>>>> tokenizedNSets; /* line numbers and local ids of the patterns tokenized ahead */
+  static string tokenizingErrorMessage; /* empty unless tokenizing ahead failed to read the file */
+  static atomic<bool> isTensorLoaded;
+  static thread tokenizingThread;
+
+  static void tokenizeAhead(const unsigned long long maxNbOfNSets);
+  static void stopTokenizingAhead(); /* also registered with atexit, in case the tensor cannot be loaded */
+  static bool getTokenizedNSet(vector<vector<unsigned int>>& tokenizedNSet); /* from the next line with some token; returns false at the end of the file */
+  static bool addPattern(const vector<vector<unsigned int>>& tokenizedNSet); /* returns false, after reporting why, if the pattern is ignored */
+  static vector<unsigned int> getDimension(const vector<vector<unsigned int>>& tokenizedNSet, const unsigned int dimensionId);
 };
 
 #endif /*PATTERN_FILE_READER_H_*/
@@ -10,7 +10,7 @@
 
 #include "RankPatterns.h"
 
-#include <thread>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <boost/lexical_cast.hpp>
@@ -21,12 +21,39 @@ vector<CandidateVariable>::iterator RankPatterns::selectedIt;
 vector<CandidateVariable>::iterator RankPatterns::selectionEnd;
 vector<CandidateVariable>::iterator RankPatterns::candidateBegin;
 vector<CandidateVariable>::iterator RankPatterns::candidateEnd;
+CandidateIndex RankPatterns::candidateIndex;
 long long RankPatterns::rssVariation;
 long long RankPatterns::maxRSSVariation;
+unsigned int RankPatterns::nbOfJobs;
+bool RankPatterns::isLazy;
+vector<long long> RankPatterns::rssVariationOffsets;
+vector<pair<long long, unsigned int>> RankPatterns::lazyCandidates;
+vector<unsigned int> RankPatterns::evaluationVersions;
+unsigned int RankPatterns::version = 0;
+vector<thread> RankPatterns::workers;
+mutex RankPatterns::workerLock;
+condition_variable RankPatterns::roundStarted;
+condition_variable RankPatterns::roundEnded;
+void (*RankPatterns::processChunk)(const unsigned int);
+unsigned int RankPatterns::nbOfChunks;
+unsigned int RankPatterns::nbOfChunksInProcess;
+unsigned int RankPatterns::nbOfRounds = 0;
+bool RankPatterns::isWorkerPoolStopped;
+const CandidateVariable* RankPatterns::lastSelectedPatternInRound;
+const vector<unsigned int>* RankPatterns::positionsInRound;
+vector<long long> RankPatterns::bestRSSVariations;
+vector<vector<CandidateVariable>::iterator> RankPatterns::bestIts;
+
+// Minimal number of patterns a thread updates after a selection: below, waking up the worker and waiting for it costs more than it saves
+static const unsigned int minNbOfPatternsPerThread = 4096;
 
 #ifdef DEBUG_SELECT
 AbstractRoughTensor* RankPatterns::roughTensorForDebug;
 #endif
+#ifdef NB_OF_ALLOCATIONS
+unsigned long long RankPatterns::nbOfAllocations = 0;
+unsigned long long RankPatterns::nbOfSelectionSteps = 0;
+#endif
 #ifdef DETAILED_TIME
 steady_clock::time_point RankPatterns::startingPoint;
 #endif
@@ -43,34 +70,272 @@ void RankPatterns::printProgressionOnSTDIN(const float stepInSeconds)
     }
 }
 
+unsigned int RankPatterns::nbOfThreads(const unsigned int nbOfPatternsToUpdate)
+{
+  return max(min(nbOfJobs, nbOfPatternsToUpdate / minNbOfPatternsPerThread), 1u);
+}
+
 void RankPatterns::updateCandidate(const CandidateVariable& lastSelectedPattern, CandidateVariable& candidate)
 {
-  const vector<vector<unsigned int>> intersection = lastSelectedPattern.inter(candidate.getNSet().begin());
-  if (!intersection.empty())
+  // Reused by every call of CandidateVariable::inter in the thread
+  static thread_local vector<vector<unsigned int>> intersection;
+  if (lastSelectedPattern.inter(candidate.getNSet().begin(), intersection))
     {
       candidate.addToRSSVariation(tensor.deltaOfRSSVariationAdding(intersection, min(lastSelectedPattern.getDensity(), candidate.getDensity())));
     }
 }
 
-void RankPatterns::selectForAddition(const CandidateVariable& lastSelectedPattern)	// selectionEnd points to the selected pattern; the patterns after selectionEnd and before candidatesEnd are the non-selected candidates to update; selectedIt will point to one of them (the next one to select, unless rssVariation == 0, which indicates the selection must end)
+void RankPatterns::updateCandidates(const CandidateVariable& lastSelectedPattern, const vector<unsigned int>::const_iterator positionBegin, const vector<unsigned int>::const_iterator positionEnd)
+{
+  for (vector<unsigned int>::const_iterator positionIt = positionBegin; positionIt != positionEnd; ++positionIt)
+    {
+      updateCandidate(lastSelectedPattern, candidateBegin[*positionIt]);
+    }
+}
+
+void RankPatterns::startWorkerPool()
+{
+  if (nbOfJobs == 1)
+    {
+      return;
+    }
+  isWorkerPoolStopped = false;
+  bestRSSVariations.resize(nbOfJobs);
+  bestIts.resize(nbOfJobs);
+  workers.reserve(nbOfJobs - 1);
+  for (unsigned int chunkId = 0; chunkId != nbOfJobs - 1; ++chunkId)
+    {
+      workers.emplace_back(work, chunkId, nbOfRounds);
+    }
+}
+
+void RankPatterns::stopWorkerPool()
+{
+  {
+    lock_guard<mutex> lock(workerLock);
+    isWorkerPoolStopped = true;
+  }
+  roundStarted.notify_all();
+  for (thread& worker : workers)
+    {
+      worker.join();
+    }
+  workers.clear();
+  workers.shrink_to_fit();
+}
+
+void RankPatterns::work(const unsigned int chunkId, unsigned int lastRound)
+{
+#ifdef NB_OF_ALLOCATIONS
+  const unsigned long long nbOfAllocationsBefore = AllocationCounter::getNbOfAllocationsInThread();
+#endif
+  unique_lock<mutex> lock(workerLock);
+  for (; ; )
+    {
+      roundStarted.wait(lock, [&lastRound]() { return isWorkerPoolStopped || nbOfRounds != lastRound; });
+      if (isWorkerPoolStopped)
+	{
+#ifdef NB_OF_ALLOCATIONS
+	  nbOfAllocations += AllocationCounter::getNbOfAllocationsInThread() - nbOfAllocationsBefore;
+#endif
+	  return;
+	}
+      lastRound = nbOfRounds;
+      if (chunkId < nbOfChunks - 1)
+	{
+	  lock.unlock();
+	  processChunk(chunkId);
+	  lock.lock();
+	  if (!--nbOfChunksInProcess)
+	    {
+	      roundEnded.notify_one();
+	    }
+	}
+    }
+}
+
+void RankPatterns::processChunksInParallel(void (*processChunkParam)(const unsigned int), const unsigned int nbOfChunksParam)
+{
+  {
+    lock_guard<mutex> lock(workerLock);
+    processChunk = processChunkParam;
+    nbOfChunks = nbOfChunksParam;
+    nbOfChunksInProcess = nbOfChunksParam - 1;
+    ++nbOfRounds;
+  }
+  roundStarted.notify_all();
+  processChunk(nbOfChunksParam - 1);
+  unique_lock<mutex> lock(workerLock);
+  roundEnded.wait(lock, []() { return !nbOfChunksInProcess; });
+}
+
+void RankPatterns::updateCandidatesInChunk(const unsigned int chunkId)
+{
+  // Every thread updates a contiguous chunk of candidates
+  const unsigned long long nbOfCandidates = positionsInRound->size();
+  updateCandidates(*lastSelectedPatternInRound, positionsInRound->begin() + nbOfCandidates * chunkId / nbOfChunks, positionsInRound->begin() + nbOfCandidates * (chunkId + 1) / nbOfChunks);
+}
+
+void RankPatterns::updateCandidatesInParallel(const CandidateVariable& lastSelectedPattern, const vector<unsigned int>& positions)
+{
+  const unsigned int nbOfChunksInStep = nbOfThreads(positions.size());
+  if (nbOfChunksInStep == 1)
+    {
+      updateCandidates(lastSelectedPattern, positions.begin(), positions.end());
+    }
+  else
+    {
+      lastSelectedPatternInRound = &lastSelectedPattern;
+      positionsInRound = &positions;
+      processChunksInParallel(updateCandidatesInChunk, nbOfChunksInStep);
+    }
+  for (const unsigned int position : positions)
+    {
+      candidateIndex.update(position);
+    }
+}
+
+void RankPatterns::initLazySelection() // the model must be empty
+{
+  rssVariationOffsets.reserve(candidateEnd - candidateBegin);
+  for (const CandidateVariable& candidate : candidates)
+    {
+      rssVariationOffsets.push_back(candidate.getRSSVariation() + tensor.deltaOfRSSVariationAdding(candidate.getNSet(), candidate.getDensity()));
+    }
+  evaluationVersions.resize(candidateEnd - candidateBegin);
+  lazyCandidates.reserve(candidateEnd - candidateBegin);
+}
+
+void RankPatterns::rebuildLazyCandidates() // the non-selected candidates must have been reset or updated for every pattern in the model
+{
+  lazyCandidates.clear();
+  const unsigned int end = candidateEnd - candidateBegin;
+  for (unsigned int position = selectionEnd - candidateBegin; position != end; ++position)
+    {
+      const unsigned int id = candidateIndex.getId(position);
+      lazyCandidates.emplace_back(candidateBegin[position].getRSSVariation(), id);
+      evaluationVersions[id] = 0;
+    }
+  make_heap(lazyCandidates.begin(), lazyCandidates.end(), greater<pair<long long, unsigned int>>());
+}
+
+void RankPatterns::evaluate(const CandidateVariable& lastSelectedPattern, CandidateVariable& candidate, const unsigned int id)
+{
+  // Exact RSS variation of candidate given the model (see initLazySelection), then given lastSelectedPattern, not in the model yet
+  candidate.setRSSVariation(rssVariationOffsets[id] - tensor.deltaOfRSSVariationAdding(candidate.getNSet(), candidate.getDensity()));
+  updateCandidate(lastSelectedPattern, candidate);
+}
+
+void RankPatterns::selectForAdditionLazily(const CandidateVariable& lastSelectedPattern) // same contract as selectForAddition
 {
+  // Adding a pattern to the model usually increases the RSS variations of the candidates: re-evaluate the candidate with the smallest RSS variation, as it was last evaluated, until it was evaluated after lastSelectedPattern; then, as selectForAddition, elect the first such candidate in case of equality
+  const unsigned int begin = ++selectionEnd - candidateBegin;
+  ++version;
   rssVariation = maxRSSVariation;
-  for (vector<CandidateVariable>::iterator candidateIt = ++selectionEnd; candidateIt != candidateEnd; ++candidateIt)
+  unsigned int bestPosition = CandidateIndex::noPosition;
+  static vector<pair<long long, unsigned int>> bestCandidates; // popped from lazyCandidates while looking for equally good ones
+  bestCandidates.clear();
+  while (!lazyCandidates.empty() && lazyCandidates.front().first < maxRSSVariation && (bestPosition == CandidateIndex::noPosition || lazyCandidates.front().first == rssVariation))
     {
-      updateCandidate(lastSelectedPattern, *candidateIt);
-      // Figure out if *candidateIt is best candidate to select so far
-      if (candidateIt->getRSSVariation() < rssVariation)
+      pop_heap(lazyCandidates.begin(), lazyCandidates.end(), greater<pair<long long, unsigned int>>());
+      const unsigned int id = lazyCandidates.back().second;
+      const unsigned int position = candidateIndex.getPosition(id);
+      if (position == CandidateIndex::noPosition || position < begin)
 	{
-	  rssVariation = candidateIt->getRSSVariation();
-	  selectedIt = candidateIt;
+	  // Eliminated or selected
+	  lazyCandidates.pop_back();
+	  continue;
 	}
+      if (evaluationVersions[id] == version)
+	{
+	  if (position < bestPosition)
+	    {
+	      bestPosition = position;
+	      rssVariation = lazyCandidates.back().first;
+	    }
+	  bestCandidates.push_back(lazyCandidates.back());
+	  lazyCandidates.pop_back();
+	  continue;
+	}
+      CandidateVariable& candidate = candidateBegin[position];
+      const long long lastRSSVariation = lazyCandidates.back().first;
+      evaluate(lastSelectedPattern, candidate, id);
+      evaluationVersions[id] = version;
+      lazyCandidates.back().first = candidate.getRSSVariation();
+      push_heap(lazyCandidates.begin(), lazyCandidates.end(), greater<pair<long long, unsigned int>>());
+      if (candidate.getRSSVariation() < lastRSSVariation)
+	{
+	  // Adding lastSelectedPattern to the model decreased the RSS variation of the candidate: the other candidates, not re-evaluated, may be better than they look
+	  lazyCandidates.insert(lazyCandidates.end(), bestCandidates.begin(), bestCandidates.end());
+	  selectForAdditionExactly(lastSelectedPattern);
+	  return;
+	}
+    }
+  for (const pair<long long, unsigned int>& bestCandidate : bestCandidates)
+    {
+      lazyCandidates.push_back(bestCandidate);
+      push_heap(lazyCandidates.begin(), lazyCandidates.end(), greater<pair<long long, unsigned int>>());
+    }
+  if (bestPosition != CandidateIndex::noPosition)
+    {
+      selectedIt = candidateBegin + bestPosition;
+    }
+}
+
+void RankPatterns::selectForAdditionExactly(const CandidateVariable& lastSelectedPattern) // same contract as selectForAddition, except that selectionEnd was already incremented
+{
+  // Re-evaluate every candidate that was not evaluated after lastSelectedPattern, elect the first one with the smallest RSS variation and rebuild lazyCandidates
+  rssVariation = maxRSSVariation;
+  lazyCandidates.clear();
+  const unsigned int end = candidateEnd - candidateBegin;
+  for (unsigned int position = selectionEnd - candidateBegin; position != end; ++position)
+    {
+      const unsigned int id = candidateIndex.getId(position);
+      CandidateVariable& candidate = candidateBegin[position];
+      if (evaluationVersions[id] != version)
+	{
+	  evaluate(lastSelectedPattern, candidate, id);
+	  evaluationVersions[id] = version;
+	}
+      lazyCandidates.emplace_back(candidate.getRSSVariation(), id);
+      if (candidate.getRSSVariation() < rssVariation)
+	{
+	  rssVariation = candidate.getRSSVariation();
+	  selectedIt = candidateBegin + position;
+	}
+    }
+  make_heap(lazyCandidates.begin(), lazyCandidates.end(), greater<pair<long long, unsigned int>>());
+}
+
+void RankPatterns::selectForAddition(const CandidateVariable& lastSelectedPattern)	// selectionEnd points to the selected pattern; the patterns after selectionEnd and before candidatesEnd are the non-selected candidates to update; selectedIt will point to one of them (the next one to select, unless rssVariation == 0, which indicates the selection must end)
+{
+#ifdef NB_OF_ALLOCATIONS
+  ++nbOfSelectionSteps;
+#endif
+  if (isLazy)
+    {
+      selectForAdditionLazily(lastSelectedPattern);
+      return;
+    }
+  // Only the candidates overlapping lastSelectedPattern have their RSS variations changing
+  const unsigned int begin = ++selectionEnd - candidateBegin;
+  const unsigned int end = candidateEnd - candidateBegin;
+  updateCandidatesInParallel(lastSelectedPattern, candidateIndex.overlappingPositions(lastSelectedPattern.getNSet(), begin, end));
+  // Elect the first candidate with the smallest RSS variation, if below maxRSSVariation
+  rssVariation = maxRSSVariation;
+  const unsigned int bestPosition = candidateIndex.bestPosition(begin, end);
+  if (bestPosition != CandidateIndex::noPosition && candidateBegin[bestPosition].getRSSVariation() < rssVariation)
+    {
+      rssVariation = candidateBegin[bestPosition].getRSSVariation();
+      selectedIt = candidateBegin + bestPosition;
     }
 }
 
 void RankPatterns::updatePreviouslySelected(const CandidateVariable& lastSelectedPattern, CandidateVariable& previouslySelected)
 {
-  const vector<vector<unsigned int>> intersection = lastSelectedPattern.inter(previouslySelected.getNSet().begin());
-  if (!intersection.empty())
+  // Reused by every call of CandidateVariable::inter in the thread
+  static thread_local vector<vector<unsigned int>> intersection;
+  if (lastSelectedPattern.inter(previouslySelected.getNSet().begin(), intersection))
     {
       if (lastSelectedPattern.getDensity() < previouslySelected.getDensity())
 	{
@@ -81,18 +346,61 @@ void RankPatterns::updatePreviouslySelected(const CandidateVariable& lastSelecte
     }
 }
 
-void RankPatterns::selectForRemoval(const CandidateVariable& lastSelectedPattern)
+void RankPatterns::updatePreviouslySelectedOnes(const CandidateVariable& lastSelectedPattern, const vector<CandidateVariable>::iterator begin, const vector<CandidateVariable>::iterator end, long long& bestRSSVariation, vector<CandidateVariable>::iterator& bestIt)
 {
-  rssVariation = maxRSSVariation;
-  for (vector<CandidateVariable>::iterator previouslySelectedIt = candidateBegin; previouslySelectedIt != selectionEnd; ++previouslySelectedIt)
+  for (vector<CandidateVariable>::iterator previouslySelectedIt = begin; previouslySelectedIt != end; ++previouslySelectedIt)
     {
       updatePreviouslySelected(lastSelectedPattern, *previouslySelectedIt);
       // Figure out if *previouslySelectedIt is best candidate to select so far
-      if (previouslySelectedIt->getRSSVariation() >= rssVariation)
+      if (previouslySelectedIt->getRSSVariation() >= bestRSSVariation)
+	{
+	  bestRSSVariation = previouslySelectedIt->getRSSVariation();
+	  bestIt = previouslySelectedIt;
+	}
+    }
+}
+
+void RankPatterns::updatePreviouslySelectedInIndex()
+{
+  const unsigned int end = selectionEnd - candidateBegin;
+  for (unsigned int position = 0; position != end; ++position)
+    {
+      candidateIndex.update(position);
+    }
+}
+
+void RankPatterns::updatePreviouslySelectedInChunk(const unsigned int chunkId)
+{
+  // Same chunks as in updateCandidatesInChunk
+  const unsigned long long nbOfPreviouslySelected = selectionEnd - candidateBegin;
+  bestRSSVariations[chunkId] = maxRSSVariation;
+  bestIts[chunkId] = selectedIt;
+  updatePreviouslySelectedOnes(*lastSelectedPatternInRound, candidateBegin + nbOfPreviouslySelected * chunkId / nbOfChunks, candidateBegin + nbOfPreviouslySelected * (chunkId + 1) / nbOfChunks, bestRSSVariations[chunkId], bestIts[chunkId]);
+}
+
+void RankPatterns::selectForRemoval(const CandidateVariable& lastSelectedPattern)
+{
+  rssVariation = maxRSSVariation;
+  const unsigned int nbOfChunksInStep = nbOfThreads(selectionEnd - candidateBegin);
+  if (nbOfChunksInStep == 1)
+    {
+      updatePreviouslySelectedOnes(lastSelectedPattern, candidateBegin, selectionEnd, rssVariation, selectedIt);
+      updatePreviouslySelectedInIndex();
+      return;
+    }
+  lastSelectedPatternInRound = &lastSelectedPattern;
+  processChunksInParallel(updatePreviouslySelectedInChunk, nbOfChunksInStep);
+  updatePreviouslySelectedInIndex();
+  const vector<long long>::const_iterator bestRSSVariationEnd = bestRSSVariations.begin() + nbOfChunksInStep;
+  vector<vector<CandidateVariable>::iterator>::const_iterator bestItIt = bestIts.begin();
+  for (vector<long long>::const_iterator bestRSSVariationIt = bestRSSVariations.begin(); bestRSSVariationIt != bestRSSVariationEnd; ++bestRSSVariationIt)
+    {
+      if (*bestRSSVariationIt >= rssVariation)
 	{
-	  rssVariation = previouslySelectedIt->getRSSVariation();
-	  selectedIt = previouslySelectedIt;
+	  rssVariation = *bestRSSVariationIt;
+	  selectedIt = *bestItIt;
 	}
+      ++bestItIt;
     }
 }
 
@@ -107,11 +415,14 @@ void RankPatterns::reselectOne() // Reselect *selectedIt only updating the rest
   for (; patternIt != selectedIt; ++patternIt)
     {
       updatePreviouslySelected(*selectedIt, *patternIt);
+      candidateIndex.update(patternIt - candidateBegin);
     }
-  while (++patternIt != candidateEnd)
+  if (isLazy)
     {
-      updateCandidate(*selectedIt, *patternIt);
+      // The candidates are evaluated when needed
+      return;
     }
+  updateCandidatesInParallel(*selectedIt, candidateIndex.overlappingPositions(selectedIt->getNSet(), ++patternIt - candidateBegin, candidateEnd - candidateBegin));
 }
 
 void RankPatterns::reselect()
@@ -120,6 +431,11 @@ void RankPatterns::reselect()
     {
       selectedIt->reset();
     }
+  candidateIndex.rebuild();
+  if (isLazy)
+    {
+      rebuildLazyCandidates();
+    }
   selectedIt = candidateBegin;
   --selectionEnd;
   if (selectionEnd == selectedIt)
@@ -154,6 +470,20 @@ void RankPatterns::reselect()
 
 void RankPatterns::output(const AbstractRoughTensor* roughTensor, const bool isRSSPrinted, const vector<double>& rssHistory, const float verboseStep)
 {
+#ifdef NB_OF_ALLOCATIONS
+  nbOfAllocations = AllocationCounter::getNbOfAllocationsInThread() - nbOfAllocations;
+#endif
+  stopWorkerPool(); // the workers add their allocations to nbOfAllocations
+  candidateIndex.clear();
+  if (isLazy)
+    {
+      rssVariationOffsets.clear();
+      rssVariationOffsets.shrink_to_fit();
+      lazyCandidates.clear();
+      lazyCandidates.shrink_to_fit();
+      evaluationVersions.clear();
+      evaluationVersions.shrink_to_fit();
+    }
   if (verboseStep)
     {
       if (verboseStep > 0)
@@ -182,6 +512,12 @@ void RankPatterns::output(const AbstractRoughTensor* roughTensor, const bool isR
 	  roughTensor->output(selectedIt->getNSet(), selectedIt->getDensity());
 	}
     }
+#ifdef NB_OF_ALLOCATIONS
+  if (nbOfSelectionSteps)
+    {
+      cout << "Nb of allocations per selection step: " << static_cast<double>(nbOfAllocations) / nbOfSelectionSteps << '\n';
+    }
+#endif
 #ifdef NB_OF_PATTERNS
 #ifdef GNUPLOT
   cout << '\t' << selectionEnd - candidateBegin;
@@ -198,8 +534,10 @@ void RankPatterns::output(const AbstractRoughTensor* roughTensor, const bool isR
 #endif
 }
 
-void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseStep, const unsigned int maxSelectionSize, const SelectionCriterion selectionCriterion, const bool isRSSPrinted)
+void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseStep, const unsigned int maxSelectionSize, const SelectionCriterion selectionCriterion, const bool isRSSPrinted, const unsigned int nbOfJobsParam, const bool isLazyParam)
 {
+  nbOfJobs = nbOfJobsParam;
+  isLazy = isLazyParam;
 #ifdef NB_OF_PATTERNS
 #ifdef GNUPLOT
   cout << '\t' << AbstractRoughTensor::candidateVariables.size();
@@ -281,6 +619,11 @@ void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseSte
   vector<double> rssHistory;
   if (rssVariation < maxRSSVariation)
     {
+      candidateIndex.init(candidateBegin, candidateEnd);
+      if (isLazy)
+	{
+	  initLazySelection();
+	}
       if (verboseStep > 0)
 	{
 	  thread(printProgressionOnSTDIN, verboseStep).detach();
@@ -294,7 +637,16 @@ void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseSte
       rssHistory.reserve(min(static_cast<unsigned int>(candidateEnd - selectionEnd), maxSelectionSize));
       rssHistory.push_back(AbstractRoughTensor::getNullModelRSS() + rssVariation);
       maxRSSVariation = rssMultiplier * rssHistory.back();
+      startWorkerPool();
+#ifdef NB_OF_ALLOCATIONS
+      nbOfAllocations = AllocationCounter::getNbOfAllocationsInThread();
+#endif
       swap(*selectionEnd, *selectedIt);
+      candidateIndex.swap(selectionEnd - candidateBegin, selectedIt - candidateBegin);
+      if (isLazy)
+	{
+	  rebuildLazyCandidates();
+	}
       {
 	// Add *selectedIt to selection
 	const CandidateVariable& selectedPattern = *selectionEnd;
@@ -327,6 +679,7 @@ void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseSte
 	      rssHistory.push_back(rssHistory.back() + selectedIt->getRSSVariation());
 	      maxRSSVariation = rssMultiplier * rssHistory.back();
 	      swap(*selectionEnd, *selectedIt);
+	      candidateIndex.swap(selectionEnd - candidateBegin, selectedIt - candidateBegin);
 	      const CandidateVariable& selectedPattern = *selectionEnd;
 	      selectForAddition(selectedPattern);
 	      tensor.addPatternToModel(selectedPattern.getNSet(), selectedPattern.getDensity());
@@ -350,6 +703,7 @@ void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseSte
 	  // Truncate selection at selectedIt, which is eliminated
 	  selectionEnd = selectedIt;
 	  *selectionEnd = std::move(*--candidateEnd);
+	  candidateIndex.erase(selectionEnd - candidateBegin, candidateEnd - candidateBegin);
 	  if (selectionEnd != candidateBegin)
 	    {
 	      // Some pattern(s) to reselect
@@ -383,7 +737,13 @@ void RankPatterns::rank(AbstractRoughTensor* roughTensor, const float verboseSte
 #endif
 	  rssHistory.push_back(AbstractRoughTensor::getNullModelRSS() + rssVariation);
 	  maxRSSVariation = rssMultiplier * rssHistory.back();
+	  candidateIndex.rebuild();
 	  swap(*selectionEnd, *selectedIt);
+	  candidateIndex.swap(selectionEnd - candidateBegin, selectedIt - candidateBegin);
+	  if (isLazy)
+	    {
+	      rebuildLazyCandidates();
+	    }
 	  const CandidateVariable& selectedPattern = *selectionEnd;
 	  selectForAddition(selectedPattern);
 	  tensor.addFirstPatternToModel(selectedPattern.getNSet(), selectedPattern.getDensity());
@@ -11,14 +11,20 @@
 #ifndef RANK_PATTERNS_H_
 #define RANK_PATTERNS_H_
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 #include "SelectionCriterion.h"
 #include "AbstractRoughTensor.h"
 #include "CandidateVariable.h"
+#include "CandidateIndex.h"
+#include "AllocationCounter.h"
 
 class RankPatterns
 {
  public:
-  static void rank(AbstractRoughTensor* roughTensor, const float verboseStep, const unsigned int maxSelectionSize, const SelectionCriterion selectionCriterion, const bool isRSSPrinted);
+  static void rank(AbstractRoughTensor* roughTensor, const float verboseStep, const unsigned int maxSelectionSize, const SelectionCriterion selectionCriterion, const bool isRSSPrinted, const unsigned int nbOfJobs, const bool isLazy);
 
  private:
   static TrieWithPrediction tensor;
@@ -27,21 +33,63 @@ class RankPatterns
   static vector<CandidateVariable>::iterator selectionEnd;
   static vector<CandidateVariable>::iterator candidateBegin;
   static vector<CandidateVariable>::iterator candidateEnd;
+  static CandidateIndex candidateIndex;
   static long long rssVariation;
   static long long maxRSSVariation;
+  static unsigned int nbOfJobs; // threads updating the candidates after every selection
+  static bool isLazy;
+  static vector<long long> rssVariationOffsets; // indexed by candidate id: with an empty model, RSS variation of the candidate minus its exact computation in the tensor
+  static vector<pair<long long, unsigned int>> lazyCandidates; // min-heap of the RSS variations of the non-selected candidates, as they were when last evaluated, and their ids
+  static vector<unsigned int> evaluationVersions; // indexed by candidate id: version of the model when last evaluated
+  static unsigned int version;
+
+  // Pool of nbOfJobs - 1 workers, living as long as the selection: at every round, the worker with id chunkId processes the chunk with that id, if it is not the last one, which the selecting thread processes
+  static vector<thread> workers;
+  static mutex workerLock;
+  static condition_variable roundStarted;
+  static condition_variable roundEnded;
+  static void (*processChunk)(const unsigned int chunkId);
+  static unsigned int nbOfChunks; // in the current round
+  static unsigned int nbOfChunksInProcess; // by the workers, in the current round
+  static unsigned int nbOfRounds; // started so far
+  static bool isWorkerPoolStopped;
+  static const CandidateVariable* lastSelectedPatternInRound;
+  static const vector<unsigned int>* positionsInRound;
+  static vector<long long> bestRSSVariations; // indexed by chunk id
+  static vector<vector<CandidateVariable>::iterator> bestIts; // indexed by chunk id
 
 #ifdef DEBUG_SELECT
   static AbstractRoughTensor* roughTensorForDebug;
 #endif
+#ifdef NB_OF_ALLOCATIONS
+  static unsigned long long nbOfAllocations; // in the thread selecting and in the workers, from the first selection step
+  static unsigned long long nbOfSelectionSteps;
+#endif
 #ifdef DETAILED_TIME
   static steady_clock::time_point startingPoint;
 #endif
 
   static void printProgressionOnSTDIN(const float stepInSeconds);
 
+  static unsigned int nbOfThreads(const unsigned int nbOfPatternsToUpdate);
+  static void startWorkerPool();
+  static void stopWorkerPool();
+  static void work(const unsigned int chunkId, unsigned int lastRound);
+  static void processChunksInParallel(void (*processChunkParam)(const unsigned int), const unsigned int nbOfChunksParam); // returns when every chunk is processed
   static void updateCandidate(const CandidateVariable& lastSelectedPattern, CandidateVariable& candidate);
+  static void updateCandidates(const CandidateVariable& lastSelectedPattern, const vector<unsigned int>::const_iterator positionBegin, const vector<unsigned int>::const_iterator positionEnd);
+  static void updateCandidatesInChunk(const unsigned int chunkId);
+  static void updateCandidatesInParallel(const CandidateVariable& lastSelectedPattern, const vector<unsigned int>& positions); // with nbOfThreads(positions.size()) threads, then updates candidateIndex
+  static void initLazySelection();
+  static void rebuildLazyCandidates();
+  static void evaluate(const CandidateVariable& lastSelectedPattern, CandidateVariable& candidate, const unsigned int id);
+  static void selectForAdditionLazily(const CandidateVariable& lastSelectedPattern);
+  static void selectForAdditionExactly(const CandidateVariable& lastSelectedPattern); // when selectForAdditionLazily finds out a candidate has its RSS variation decreasing
   static void selectForAddition(const CandidateVariable& lastSelectedPattern);
   static void updatePreviouslySelected(const CandidateVariable& lastSelectedPattern, CandidateVariable& previouslySelected);
+  static void updatePreviouslySelectedOnes(const CandidateVariable& lastSelectedPattern, const vector<CandidateVariable>::iterator begin, const vector<CandidateVariable>::iterator end, long long& bestRSSVariation, vector<CandidateVariable>::iterator& bestIt); // bestIt becomes the last previously selected pattern with the largest RSS variation, at least bestRSSVariation, if any
+  static void updatePreviouslySelectedInChunk(const unsigned int chunkId);
+  static void updatePreviouslySelectedInIndex();
   static void selectForRemoval(const CandidateVariable& lastSelectedPattern);
   static void reselectOne();
   static void reselect();
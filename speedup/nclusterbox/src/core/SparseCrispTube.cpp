@@ -12,6 +12,8 @@
 
 #include <algorithm>
 
+#include "FlatTrie.h"
+
 long long SparseCrispTube::defaultMembership;
 unsigned int SparseCrispTube::sizeLimit;
 
@@ -40,6 +42,11 @@ void SparseCrispTube::sortTubes()
   sort(tube.begin(), tube.end());
 }
 
+void SparseCrispTube::flatten(FlatTrie& flatTrie)
+{
+  flatTrie.addSparseCrispTube(tube);
+}
+
 void SparseCrispTube::sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& nbOfPresentTuples) const
 {
   const vector<unsigned int>::const_iterator tubeEnd = tube.end();
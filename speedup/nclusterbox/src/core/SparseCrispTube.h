@@ -22,6 +22,7 @@ class SparseCrispTube final : public AbstractData
   void setTuple(const vector<unsigned int>::const_iterator idIt);
   DenseCrispTube* getDenseRepresentation() const;
   void sortTubes();
+  void flatten(FlatTrie& flatTrie);
 
   void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& nbOfPresentTuples) const;
   int sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator numbersOfPresentTuplesIt) const;
@@ -12,6 +12,8 @@
 
 #include <algorithm>
 
+#include "FlatTrie.h"
+
 int SparseFuzzyTube::defaultMembership;
 unsigned int SparseFuzzyTube::sizeLimit;
 
@@ -40,6 +42,11 @@ void SparseFuzzyTube::sortTubes()
   sort(tube.begin(), tube.end(), [](const pair<unsigned int, int>& entry1, const pair<unsigned int, int>& entry2) {return entry1.first < entry2.first;});
 }
 
+void SparseFuzzyTube::flatten(FlatTrie& flatTrie)
+{
+  flatTrie.addSparseFuzzyTube(tube);
+}
+
 void SparseFuzzyTube::sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
 {
   unsigned int nbOfDefaultMemberships = 0;
@@ -269,6 +276,11 @@ int SparseFuzzyTube::increaseSumsOnPatternAndHyperplanes(const vector<vector<uns
   return it->second;
 }
 
+int SparseFuzzyTube::getDefaultMembership()
+{
+  return defaultMembership;
+}
+
 void SparseFuzzyTube::setDefaultMembershipAndSizeLimit(const int defaultMembershipParam, const unsigned int sizeLimitParam)
 {
   defaultMembership = defaultMembershipParam;
@@ -22,6 +22,7 @@ class SparseFuzzyTube final : public AbstractData
   void setTuple(const vector<unsigned int>::const_iterator idIt, const int membership);
   DenseFuzzyTube* getDenseRepresentation() const;
   void sortTubes();
+  void flatten(FlatTrie& flatTrie);
 
   void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
   void minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
@@ -31,6 +32,7 @@ class SparseFuzzyTube final : public AbstractData
   void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
   int increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
 
+  static int getDefaultMembership();
   static void setDefaultMembershipAndSizeLimit(const int defaultMembership, const unsigned int sizeLimit);
 
  private:
@@ -12,36 +12,63 @@
 
 #include "TupleWithPrediction.h"
 
-SparseRoughTensor::SparseRoughTensor(vector<FuzzyTuple>& fuzzyTuplesParam, const double shiftParam): fuzzyTuples(std::move(fuzzyTuplesParam)), shift(shiftParam)
+SparseRoughTensor::SparseRoughTensor(FuzzyTupleArray& fuzzyTuplesParam, const double shiftParam): fuzzyTuples(std::move(fuzzyTuplesParam)), binaryTensor(nullptr), fileIds2Ids(), shift(shiftParam)
 {
 }
 
+SparseRoughTensor::SparseRoughTensor(const BinaryTensorFile* binaryTensorParam, vector<vector<unsigned int>>& fileIds2IdsParam, const double shiftParam): fuzzyTuples(), binaryTensor(binaryTensorParam), fileIds2Ids(std::move(fileIds2IdsParam)), shift(shiftParam)
+{
+}
+
+SparseRoughTensor::~SparseRoughTensor()
+{
+  delete binaryTensor;
+}
+
+template<typename F> void SparseRoughTensor::forEachTuple(F process) const
+{
+  if (binaryTensor)
+    {
+      const unsigned int n = fileIds2Ids.size();
+      vector<unsigned int> tuple(n);
+      const size_t nbOfTuples = binaryTensor->size();
+      for (size_t tupleId = 0; tupleId != nbOfTuples; ++tupleId)
+	{
+	  unsigned int dimensionId = 0;
+	  for (; dimensionId != n; ++dimensionId)
+	    {
+	      const unsigned int internalDimensionId = external2InternalDimensionOrder[dimensionId];
+	      const unsigned int id = fileIds2Ids[internalDimensionId][binaryTensor->getElementId(tupleId, dimensionId)];
+	      if (id == numeric_limits<unsigned int>::max())
+		{
+		  break;
+		}
+	      tuple[internalDimensionId] = id;
+	    }
+	  if (dimensionId == n)
+	    {
+	      process(tuple.begin(), binaryTensor->getMembership(tupleId) - shift);
+	    }
+	}
+      return;
+    }
+  const size_t nbOfTuples = fuzzyTuples.size();
+  for (size_t tupleId = 0; tupleId != nbOfTuples; ++tupleId)
+    {
+      process(fuzzyTuples.getTuple(tupleId), fuzzyTuples.getMembership(tupleId));
+    }
+}
+
 Trie SparseRoughTensor::getTensor() const
 {
   Trie tensor(cardinalities.begin(), cardinalities.end());
   if (Trie::is01)
     {
-      {
-	const vector<FuzzyTuple>::const_iterator fuzzyTupleEnd = fuzzyTuples.end();
-	vector<FuzzyTuple>::const_iterator fuzzyTupleIt = fuzzyTuples.begin();
-	do
-	  {
-	    tensor.setTuple(fuzzyTupleIt->getTuple().begin());
-	  }
-	while (++fuzzyTupleIt != fuzzyTupleEnd);
-      }
+      forEachTuple([&tensor](const vector<unsigned int>::const_iterator tuple, const double shiftedMembership) {tensor.setTuple(tuple);});
       tensor.sortTubes();
       return tensor;
     }
-  {
-    const vector<FuzzyTuple>::const_iterator fuzzyTupleEnd = fuzzyTuples.end();
-    vector<FuzzyTuple>::const_iterator fuzzyTupleIt = fuzzyTuples.begin();
-    do
-      {
-	tensor.setTuple(fuzzyTupleIt->getTuple().begin(), unit * fuzzyTupleIt->getMembership());
-      }
-    while (++fuzzyTupleIt != fuzzyTupleEnd);
-  }
+  forEachTuple([&tensor](const vector<unsigned int>::const_iterator tuple, const double shiftedMembership) {tensor.setTuple(tuple, unit * shiftedMembership);});
   tensor.sortTubes();
   return tensor;
 }
@@ -49,29 +76,35 @@ Trie SparseRoughTensor::getTensor() const
 void SparseRoughTensor::setNoSelection()
 {
   fuzzyTuples.clear();
-  fuzzyTuples.shrink_to_fit();
+  delete binaryTensor;
+  binaryTensor = nullptr;
+  fileIds2Ids.clear();
+  fileIds2Ids.shrink_to_fit();
 }
 
 TrieWithPrediction SparseRoughTensor::projectTensor()
 {
-  // Update cardinalities, ids2Labels, candidateVariables, and fuzzyTuples
+  // Update cardinalities, ids2Labels, candidateVariables, and the fuzzy tuples
   const vector<vector<unsigned int>> oldIds2NewIds = projectMetadata(true);
-  vector<FuzzyTuple>::iterator fuzzyTupleEnd = fuzzyTuples.end();
-  vector<FuzzyTuple>::iterator fuzzyTupleIt = fuzzyTuples.begin();
-  do
+  if (binaryTensor)
     {
-      if (fuzzyTupleIt->setNewIds(oldIds2NewIds))
-	{
-	  ++fuzzyTupleIt;
-	}
-      else
+      vector<vector<unsigned int>>::const_iterator oldIds2NewIdsInDimensionIt = oldIds2NewIds.begin();
+      for (vector<unsigned int>& fileIds2IdsInDimension : fileIds2Ids)
 	{
-	  *fuzzyTupleIt = std::move(*--fuzzyTupleEnd);
+	  for (unsigned int& id : fileIds2IdsInDimension)
+	    {
+	      if (id != numeric_limits<unsigned int>::max())
+		{
+		  id = (*oldIds2NewIdsInDimensionIt)[id];
+		}
+	    }
+	  ++oldIds2NewIdsInDimensionIt;
 	}
     }
-  while (fuzzyTupleIt != fuzzyTupleEnd);
-  fuzzyTuples.erase(fuzzyTupleEnd, fuzzyTuples.end());
-  fuzzyTupleIt = fuzzyTuples.begin();
+  else
+    {
+      fuzzyTuples.setNewIds(oldIds2NewIds);
+    }
   // Compute negative/positive memberships of elements in first dimension and the RSS of the null model
   vector<unsigned int>::const_iterator cardinalityIt = ++cardinalities.begin();
   double totalShiftOnElementInFirstDimension = shift * *cardinalityIt;
@@ -83,33 +116,26 @@ TrieWithPrediction SparseRoughTensor::projectTensor()
   const double squaredShift = shift * shift;
   vector<double> elementPositiveMemberships(cardinalities.front());
   vector<double> elementNegativeMemberships(cardinalities.front(), totalShiftOnElementInFirstDimension);
-  do
-    {
-      const unsigned int elementId = fuzzyTupleIt->getElementId(0);
-      const double membership = fuzzyTupleIt->getMembership();
-      if (membership > 0)
-	{
-	  elementPositiveMemberships[elementId] += membership;
-	  elementNegativeMemberships[elementId] -= shift;
-	}
-      else
-	{
-	  elementNegativeMemberships[elementId] -= membership + shift;
-	}
-      rss += membership * membership - squaredShift;
-    }
-  while (++fuzzyTupleIt != fuzzyTupleEnd);
-  fuzzyTupleIt = fuzzyTuples.begin();
+  forEachTuple([this, &rss, squaredShift, &elementPositiveMemberships, &elementNegativeMemberships](const vector<unsigned int>::const_iterator tuple, const double membership)
+  {
+    const unsigned int elementId = *tuple;
+    if (membership > 0)
+      {
+	elementPositiveMemberships[elementId] += membership;
+	elementNegativeMemberships[elementId] -= shift;
+      }
+    else
+      {
+	elementNegativeMemberships[elementId] -= membership + shift;
+      }
+    rss += membership * membership - squaredShift;
+  });
   // Compute unit
   setUnitForProjectedTensor(rss, elementNegativeMemberships, elementPositiveMemberships);
   // Construct TrieWithPrediction
   TupleWithPrediction::setDefaultMembership(unit * -shift);
   TrieWithPrediction tensor(cardinalities.begin(), cardinalities.end());
-  do
-    {
-      tensor.setTuple(fuzzyTupleIt->getTuple().begin(), unit * fuzzyTupleIt->getMembership());
-    }
-  while (++fuzzyTupleIt != fuzzyTupleEnd);
+  forEachTuple([&tensor](const vector<unsigned int>::const_iterator tuple, const double shiftedMembership) {tensor.setTuple(tuple, unit * shiftedMembership);});
   setNoSelection();
   return tensor;
 }
@@ -16,7 +16,12 @@
 class SparseRoughTensor final : public AbstractRoughTensor
 {
  public:
-  SparseRoughTensor(vector<FuzzyTuple>& fuzzyTuples, const double shift);
+  SparseRoughTensor(const SparseRoughTensor& otherSparseRoughTensor) = delete;
+  SparseRoughTensor(FuzzyTupleArray& fuzzyTuples, const double shift);
+  SparseRoughTensor(const BinaryTensorFile* binaryTensor, vector<vector<unsigned int>>& fileIds2Ids, const double shift);
+  ~SparseRoughTensor();
+
+  SparseRoughTensor& operator=(const SparseRoughTensor& otherSparseRoughTensor) = delete;
 
   Trie getTensor() const;
   void setNoSelection();
@@ -25,9 +30,12 @@ class SparseRoughTensor final : public AbstractRoughTensor
   double getAverageShift(const vector<vector<unsigned int>>& nSet) const;
 
  private:
-  vector<FuzzyTuple> fuzzyTuples; /* non-empty if only if patterns are to be selected */
-  /* PERF: a specific class for a 0/1 tensor where memberships are not stored */
+  FuzzyTupleArray fuzzyTuples; /* non-empty if only if patterns are to be selected and the tuples are not streamed; for a 0/1 tensor, the memberships are not stored */
+  const BinaryTensorFile* binaryTensor; /* nullptr unless the tuples are streamed from that file and patterns are to be selected */
+  vector<vector<unsigned int>> fileIds2Ids; /* if the tuples are streamed, for every internal dimension, the id of every element in the file (numeric_limits<unsigned int>::max() if projected out) */
   const double shift;
+
+  template<typename F> void forEachTuple(F process) const; /* calls process(tuple, shiftedMembership), with the tuple in the internal dimension order */
 };
 
 #endif /*SPARSE_ROUGH_TENSOR_H_*/
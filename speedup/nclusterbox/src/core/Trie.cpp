@@ -12,23 +12,38 @@
 
 #include "SparseCrispTube.h"
 #include "SparseFuzzyTube.h"
+#include "FlatTrie.h"
 
 bool Trie::is01;
 
-Trie::Trie(): hyperplanes()
+// Kinds of tubes, chosen once for all through is01
+struct CrispTubes
+{
+  typedef SparseCrispTube Sparse;
+  typedef DenseCrispTube Dense;
+};
+
+struct FuzzyTubes
+{
+  typedef SparseFuzzyTube Sparse;
+  typedef DenseFuzzyTube Dense;
+};
+
+Trie::Trie(): hyperplanes(), isDenseTube()
 {
 }
 
-Trie::Trie(Trie&& otherTrie): hyperplanes(std::move(otherTrie.hyperplanes))
+Trie::Trie(Trie&& otherTrie): hyperplanes(std::move(otherTrie.hyperplanes)), isDenseTube(std::move(otherTrie.isDenseTube))
 {
 }
 
-Trie::Trie(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes()
+Trie::Trie(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes(), isDenseTube()
 {
   unsigned int cardinality = *cardinalityIt;
   hyperplanes.reserve(cardinality);
   if (cardinalityIt + 2 == cardinalityEnd)
     {
+      isDenseTube.resize(cardinality);
       if (is01)
 	{
 	  do
@@ -53,12 +68,13 @@ Trie::Trie(const vector<unsigned int>::const_iterator cardinalityIt, const vecto
   while (--cardinality);
 }
 
-Trie::Trie(vector<double>::const_iterator& membershipIt, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes()
+Trie::Trie(vector<double>::const_iterator& membershipIt, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes(), isDenseTube()
 {
   unsigned int cardinality = *cardinalityIt;
   hyperplanes.reserve(cardinality);
   if (cardinalityIt + 2 == cardinalityEnd)
     {
+      isDenseTube.resize(cardinality, true);
       do
 	{
 	  hyperplanes.push_back(new DenseCrispTube(membershipIt));
@@ -74,12 +90,13 @@ Trie::Trie(vector<double>::const_iterator& membershipIt, const vector<unsigned i
   while (--cardinality);
 }
 
-Trie::Trie(vector<double>::const_iterator& membershipIt, const int unit, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes()
+Trie::Trie(vector<double>::const_iterator& membershipIt, const int unit, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes(), isDenseTube()
 {
   unsigned int cardinality = *cardinalityIt;
   hyperplanes.reserve(cardinality);
   if (cardinalityIt + 2 == cardinalityEnd)
     {
+      isDenseTube.resize(cardinality, true);
       do
 	{
 	  hyperplanes.push_back(new DenseFuzzyTube(membershipIt, unit));
@@ -106,6 +123,7 @@ Trie::~Trie()
 Trie& Trie::operator=(Trie&& otherTrie)
 {
   hyperplanes = std::move(otherTrie.hyperplanes);
+  isDenseTube = std::move(otherTrie.isDenseTube);
   return *this;
 }
 
@@ -117,6 +135,7 @@ void Trie::setTuple(const vector<unsigned int>::const_iterator idIt)
       DenseCrispTube* newHyperplane = static_cast<SparseCrispTube*>(hyperplane)->getDenseRepresentation();
       delete hyperplane;
       hyperplane = newHyperplane;
+      isDenseTube[*idIt] = true;
     }
   hyperplane->setTuple(idIt + 1);
 }
@@ -129,6 +148,7 @@ void Trie::setTuple(const vector<unsigned int>::const_iterator idIt, const int m
       DenseFuzzyTube* newHyperplane = static_cast<SparseFuzzyTube*>(hyperplane)->getDenseRepresentation();
       delete hyperplane;
       hyperplane = newHyperplane;
+      isDenseTube[*idIt] = true;
     }
   hyperplane->setTuple(idIt + 1, membership);
 }
@@ -149,56 +169,65 @@ void Trie::clearAndFree()
     }
   hyperplanes.clear();
   hyperplanes.shrink_to_fit();
+  isDenseTube.clear();
+  isDenseTube.shrink_to_fit();
 }
 
-void Trie::sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+void Trie::flatten(FlatTrie& flatTrie)
 {
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
+  for (AbstractData* hyperplane : hyperplanes)
     {
-      hyperplanes[*idIt]->sumOnPattern(nextDimensionIt, sum);
+      hyperplane->flatten(flatTrie);
+      delete hyperplane;
     }
-  while (++idIt != idEnd);
+  hyperplanes.clear();
+  hyperplanes.shrink_to_fit();
+  isDenseTube.clear();
+  isDenseTube.shrink_to_fit();
 }
 
-void Trie::minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+template<typename Tubes, bool areHyperplanesTubes> void Trie::sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
 {
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
   const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
   vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
   do
     {
-      hyperplanes[*idIt]->minusSumOnPattern(nextDimensionIt, sum);
+      sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplanes.begin() + *idIt, nextDimensionIt, sum);
     }
   while (++idIt != idEnd);
 }
 
-long long Trie::membershipSum(const vector<vector<unsigned int>>& nSet) const
+template<typename Tubes, bool areHyperplanesTubes> void Trie::minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
 {
-  long long sum = 0;
-  const vector<vector<unsigned int>>::const_iterator secondDimensionIt = ++nSet.begin();
-  const vector<unsigned int>::const_iterator idEnd = nSet.front().end();
-  vector<unsigned int>::const_iterator idIt = nSet.front().begin();
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
+  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
   do
     {
-      int sumOnSlice = 0;
-      hyperplanes[*idIt]->sumOnPattern(secondDimensionIt, sumOnSlice);
-      sum += sumOnSlice;
+      minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplanes.begin() + *idIt, nextDimensionIt, sum);
     }
   while (++idIt != idEnd);
-  return sum;
 }
 
-long long Trie::nbOfPresentTuples(const vector<vector<unsigned int>>& nSet) const
+long long Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const
 {
-  int nb = 0;
-  sumOnPattern(nSet.begin(), nb);
-  return nb;
+  if (is01)
+    {
+      if (isDenseTube.empty())
+	{
+	  return sumsOnPatternAndHyperplanes<CrispTubes, false>(nSetBegin, sumsOnHyperplanes);
+	}
+      return sumsOnPatternAndHyperplanes<CrispTubes, true>(nSetBegin, sumsOnHyperplanes);
+    }
+  if (isDenseTube.empty())
+    {
+      return sumsOnPatternAndHyperplanes<FuzzyTubes, false>(nSetBegin, sumsOnHyperplanes);
+    }
+  return sumsOnPatternAndHyperplanes<FuzzyTubes, true>(nSetBegin, sumsOnHyperplanes);
 }
 
-long long Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const
+template<typename Tubes, bool areHyperplanesTubes> long long Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const
 {
   const vector<vector<int>>::iterator sumsEnd = sumsOnHyperplanes.end();
   vector<vector<int>>::iterator sumsIt = sumsOnHyperplanes.begin();
@@ -222,10 +251,10 @@ long long Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+	    sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	const int sum = (*hyperplaneIt)->sumsOnPatternAndHyperplanes(nextDimensionIt, sumsIt);
+	const int sum = sumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, sumsIt);
 	sumOnPattern += sum;
 	*sumIt++ += sum;
 	++hyperplaneIt;
@@ -235,7 +264,7 @@ long long Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+      sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
   return sumOnPattern;
@@ -265,7 +294,7 @@ long long Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::
   return sumOnPattern;
 }
 
-int Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+template<typename Tubes, bool areHyperplanesTubes> int Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   int sumOnPattern = 0;
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
@@ -281,10 +310,10 @@ int Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+	    sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	const int sum = (*hyperplaneIt)->sumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	const int sum = sumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	sumOnPattern += sum;
 	*sumIt++ += sum;
 	++hyperplaneIt;
@@ -294,13 +323,13 @@ int Trie::sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+      sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
   return sumOnPattern;
 }
 
-int Trie::minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+template<typename Tubes, bool areHyperplanesTubes> int Trie::minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   int sumOnPattern = 0;
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
@@ -316,10 +345,10 @@ int Trie::minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::c
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+	    minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	const int sum = (*hyperplaneIt)->minusSumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	const int sum = minusSumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	*sumIt++ -= sum;
 	sumOnPattern += sum;
 	++hyperplaneIt;
@@ -329,13 +358,33 @@ int Trie::minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::c
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+      minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
   return sumOnPattern;
 }
 
 void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums) const
+{
+  if (is01)
+    {
+      if (isDenseTube.empty())
+	{
+	  increaseSumsOnHyperplanes<CrispTubes, false>(dimensionBegin, increasedDimensionId, sums);
+	  return;
+	}
+      increaseSumsOnHyperplanes<CrispTubes, true>(dimensionBegin, increasedDimensionId, sums);
+      return;
+    }
+  if (isDenseTube.empty())
+    {
+      increaseSumsOnHyperplanes<FuzzyTubes, false>(dimensionBegin, increasedDimensionId, sums);
+      return;
+    }
+  increaseSumsOnHyperplanes<FuzzyTubes, true>(dimensionBegin, increasedDimensionId, sums);
+}
+
+template<typename Tubes, bool areHyperplanesTubes> void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums) const
 {
   if (increasedDimensionId)
     {
@@ -355,10 +404,10 @@ void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
 	  {
 	    for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	      {
-		(*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+		sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 		++sumIt;
 	      }
-	    *sumIt++ += (*hyperplaneIt)->increaseSumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	    *sumIt++ += increaseSumsOnPatternAndHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	    ++hyperplaneIt;
 	  }
 	while (++presentElementIdIt != presentElementIdEnd);
@@ -366,16 +415,16 @@ void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
       // Hyperplanes after the last present one
       for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
 	{
-	  (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+	  sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	  ++sumIt;
 	}
       empty.swap(unchangedSums);
       return;
     }
-  hyperplanes[dimensionBegin->front()]->increaseSumsOnHyperplanes(dimensionBegin + 1, ++sums.begin());
+  increaseSumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplanes.begin() + dimensionBegin->front(), dimensionBegin + 1, ++sums.begin());
 }
 
-void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+template<typename Tubes, bool areHyperplanesTubes> void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   // sumsOnPatternAndHyperplanes without computing the sumOnPattern
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
@@ -391,10 +440,10 @@ void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+	    sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	*sumIt++ += (*hyperplaneIt)->sumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	*sumIt++ += sumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	++hyperplaneIt;
       }
     while (++presentElementIdIt != presentElementIdEnd);
@@ -402,7 +451,7 @@ void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+      sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
 }
@@ -410,6 +459,16 @@ void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
 void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int decreasedDimensionId, vector<vector<int>>& sums) const
 {
   // !is01
+  if (isDenseTube.empty())
+    {
+      decreaseSumsOnHyperplanes<FuzzyTubes, false>(dimensionBegin, decreasedDimensionId, sums);
+      return;
+    }
+  decreaseSumsOnHyperplanes<FuzzyTubes, true>(dimensionBegin, decreasedDimensionId, sums);
+}
+
+template<typename Tubes, bool areHyperplanesTubes> void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int decreasedDimensionId, vector<vector<int>>& sums) const
+{
   if (decreasedDimensionId)
     {
       vector<int>& unchangedSums = sums[decreasedDimensionId];
@@ -428,10 +487,10 @@ void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
 	  {
 	    for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	      {
-		(*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+		minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 		++sumIt;
 	      }
-	    *sumIt++ -= (*hyperplaneIt)->decreaseSumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	    *sumIt++ -= decreaseSumsOnPatternAndHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	    ++hyperplaneIt;
 	  }
 	while (++presentElementIdIt != presentElementIdEnd);
@@ -439,16 +498,16 @@ void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
       // Hyperplanes after the last present one
       for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
 	{
-	  (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+	  minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	  ++sumIt;
 	}
       empty.swap(unchangedSums);
       return;
     }
-  hyperplanes[dimensionBegin->front()]->decreaseSumsOnHyperplanes(dimensionBegin + 1, ++sums.begin());
+  decreaseSumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplanes.begin() + dimensionBegin->front(), dimensionBegin + 1, ++sums.begin());
 }
 
-void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+template<typename Tubes, bool areHyperplanesTubes> void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   // minusSumsOnPatternAndHyperplanes without computing the sumOnPattern
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
@@ -464,10 +523,10 @@ void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+	    minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	*sumIt++ -= (*hyperplaneIt)->minusSumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	*sumIt++ -= minusSumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	++hyperplaneIt;
       }
     while (++presentElementIdIt != presentElementIdEnd);
@@ -475,16 +534,16 @@ void Trie::decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+      minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
 }
 
-int Trie::increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+template<typename Tubes, bool areHyperplanesTubes> int Trie::increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   if (sumsIt->empty())
     {
-      return hyperplanes[dimensionIt->front()]->sumsOnPatternAndHyperplanes(dimensionIt + 1, sumsIt + 1);
+      return sumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplanes.begin() + dimensionIt->front(), dimensionIt + 1, sumsIt + 1);
     }
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
   int sumOnPattern = 0;
@@ -500,10 +559,10 @@ int Trie::increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+	    sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	const int sum = (*hyperplaneIt)->increaseSumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	const int sum = increaseSumsOnPatternAndHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	*sumIt++ += sum;
 	sumOnPattern += sum;
 	++hyperplaneIt;
@@ -513,17 +572,17 @@ int Trie::increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->sumOnPattern(nextDimensionIt, *sumIt);
+      sumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
   return sumOnPattern;
 }
 
-int Trie::decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+template<typename Tubes, bool areHyperplanesTubes> int Trie::decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
 {
   if (sumsIt->empty())
     {
-      return hyperplanes[dimensionIt->front()]->minusSumsOnPatternAndHyperplanes(dimensionIt + 1, sumsIt + 1);
+      return minusSumsOnHyperplane<Tubes, areHyperplanesTubes>(hyperplanes.begin() + dimensionIt->front(), dimensionIt + 1, sumsIt + 1);
     }
   const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
   int sumOnPattern = 0;
@@ -539,10 +598,10 @@ int Trie::decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>
       {
 	for (const vector<AbstractData*>::const_iterator end = hyperplaneBegin + *presentElementIdIt; hyperplaneIt != end; ++hyperplaneIt)
 	  {
-	    (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+	    minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
 	    ++sumIt;
 	  }
-	const int sum = (*hyperplaneIt)->decreaseSumsOnPatternAndHyperplanes(nextDimensionIt, nextSumsIt);
+	const int sum = decreaseSumsOnPatternAndHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, nextSumsIt);
 	*sumIt++ -= sum;
 	sumOnPattern += sum;
 	++hyperplaneIt;
@@ -552,7 +611,7 @@ int Trie::decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>
   // Hyperplanes after the last present one
   for (const vector<AbstractData*>::const_iterator hyperplaneEnd = hyperplanes.end(); hyperplaneIt != hyperplaneEnd; ++hyperplaneIt)
     {
-      (*hyperplaneIt)->minusSumOnPattern(nextDimensionIt, *sumIt);
+      minusSumOnHyperplane<Tubes, areHyperplanesTubes>(hyperplaneIt, nextDimensionIt, *sumIt);
       ++sumIt;
     }
   return sumOnPattern;
@@ -561,18 +620,15 @@ int Trie::decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>
 void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums, const int area, const int unit) const
 {
   // is01
-  vector<vector<int>> increases;
-  increases.reserve(sums.size());
+  static thread_local vector<vector<int>> increases; // reused from one call to the next, not to allocate memory at every step
+  increases.resize(sums.size());
   vector<vector<int>>::iterator sumsIt = sums.begin();
-  for (const vector<vector<int>>::const_iterator end = sums.begin() + increasedDimensionId; sumsIt != end; ++sumsIt)
-    {
-      increases.emplace_back(sumsIt->size());
-    }
-  increases.emplace_back();
-  for (const vector<vector<int>>::const_iterator sumsEnd = sums.end(); ++sumsIt != sumsEnd; )
+  for (vector<int>& increasesInDimension : increases)
     {
-      increases.emplace_back(sumsIt->size());
+      increasesInDimension.assign(sumsIt->size(), 0);
+      ++sumsIt;
     }
+  increases[increasedDimensionId].clear();
   increaseSumsOnHyperplanes(dimensionBegin, increasedDimensionId, increases);
   sumsIt = sums.begin();
   const int defaultNSetMembership = SparseCrispTube::getDefaultMembership() * area;
@@ -599,3 +655,180 @@ void Trie::increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_i
 	}
     }
 }
+
+template<typename Tubes, bool areHyperplanesTubes> void Trie::sumOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->sumOnPattern(dimensionIt, sum);
+	  return;
+	}
+      static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->sumOnPattern(dimensionIt, sum);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  hyperplane->sumOnPattern<Tubes, false>(dimensionIt, sum);
+	  return;
+	}
+      hyperplane->sumOnPattern<Tubes, true>(dimensionIt, sum);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> void Trie::minusSumOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->minusSumOnPattern(dimensionIt, sum);
+	  return;
+	}
+      static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->minusSumOnPattern(dimensionIt, sum);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  hyperplane->minusSumOnPattern<Tubes, false>(dimensionIt, sum);
+	  return;
+	}
+      hyperplane->minusSumOnPattern<Tubes, true>(dimensionIt, sum);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> int Trie::sumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  return static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->sumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+	}
+      return static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->sumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  return hyperplane->sumsOnPatternAndHyperplanes<Tubes, false>(dimensionIt, sumsIt);
+	}
+      return hyperplane->sumsOnPatternAndHyperplanes<Tubes, true>(dimensionIt, sumsIt);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> int Trie::minusSumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  return static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->minusSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+	}
+      return static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->minusSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  return hyperplane->minusSumsOnPatternAndHyperplanes<Tubes, false>(dimensionIt, sumsIt);
+	}
+      return hyperplane->minusSumsOnPatternAndHyperplanes<Tubes, true>(dimensionIt, sumsIt);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> void Trie::increaseSumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->increaseSumsOnHyperplanes(dimensionIt, sumsIt);
+	  return;
+	}
+      static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->increaseSumsOnHyperplanes(dimensionIt, sumsIt);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  hyperplane->increaseSumsOnHyperplanes<Tubes, false>(dimensionIt, sumsIt);
+	  return;
+	}
+      hyperplane->increaseSumsOnHyperplanes<Tubes, true>(dimensionIt, sumsIt);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> void Trie::decreaseSumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->decreaseSumsOnHyperplanes(dimensionIt, sumsIt);
+	  return;
+	}
+      static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->decreaseSumsOnHyperplanes(dimensionIt, sumsIt);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  hyperplane->decreaseSumsOnHyperplanes<Tubes, false>(dimensionIt, sumsIt);
+	  return;
+	}
+      hyperplane->decreaseSumsOnHyperplanes<Tubes, true>(dimensionIt, sumsIt);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> int Trie::increaseSumsOnPatternAndHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  return static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->increaseSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+	}
+      return static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->increaseSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  return hyperplane->increaseSumsOnPatternAndHyperplanes<Tubes, false>(dimensionIt, sumsIt);
+	}
+      return hyperplane->increaseSumsOnPatternAndHyperplanes<Tubes, true>(dimensionIt, sumsIt);
+    }
+}
+
+template<typename Tubes, bool areHyperplanesTubes> int Trie::decreaseSumsOnPatternAndHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const
+{
+  if constexpr (areHyperplanesTubes)
+    {
+      // *dimensionIt is necessarily the decreased dimension
+      if (isDenseTube[hyperplaneIt - hyperplanes.begin()])
+	{
+	  return static_cast<const typename Tubes::Dense*>(*hyperplaneIt)->increaseSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+	}
+      return static_cast<const typename Tubes::Sparse*>(*hyperplaneIt)->increaseSumsOnPatternAndHyperplanes(dimensionIt, sumsIt);
+    }
+  else
+    {
+      const Trie* hyperplane = static_cast<const Trie*>(*hyperplaneIt);
+      if (hyperplane->isDenseTube.empty())
+	{
+	  return hyperplane->decreaseSumsOnPatternAndHyperplanes<Tubes, false>(dimensionIt, sumsIt);
+	}
+      return hyperplane->decreaseSumsOnPatternAndHyperplanes<Tubes, true>(dimensionIt, sumsIt);
+    }
+}
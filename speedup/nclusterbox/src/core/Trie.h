@@ -32,27 +32,43 @@ class Trie final : public AbstractData
   void setTuple(const vector<unsigned int>::const_iterator idIt, const int membership);
   void sortTubes();
   void clearAndFree();
+  void flatten(FlatTrie& flatTrie); /* adds every tube to flatTrie, in lexicographic order, and empties *this */
 
-  long long membershipSum(const vector<vector<unsigned int>>& nSet) const; /* assumes the overall sum fits in an int */
-  long long nbOfPresentTuples(const vector<vector<unsigned int>>& nSet) const; /* assumes the sum on every slice fits in an int */
-
-  void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const; /* warning: sum cannot exceed numeric_limits<int>::max()! */
-  void minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const; /* warning: sum cannot exceed numeric_limits<int>::max()! */
   void updateSumsOnExtensionsAfterExtension(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt, const vector<vector<int>>::iterator sumsInExtendedDimensionIt) const; /* the *dimensionIt relating to *sumsInExtendedDimensionIt must contain the extension (one single element) rather than the actual dimension of the n-set */
+
   long long sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const;
   long long sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes, const unsigned long long area, const int unit) const;
-  int sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
-  int minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
   void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums) const;
-  void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
   void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int decreasedDimensionId, vector<vector<int>>& sums) const;
-  void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
-  int increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
-  int decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
   void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums, const int area, const int unit) const;
 
  private:
   vector<AbstractData*> hyperplanes;
+  vector<bool> isDenseTube;	/* empty unless the hyperplanes are tubes, in which case it tells the dense ones */
+
+  // The public members choose, through is01, the kind of tubes (CrispTubes or FuzzyTubes, defined in Trie.cpp) the templates below call without any virtual call; areHyperplanesTubes tells whether hyperplanes contains tubes (rather than Tries)
+  template<typename Tubes, bool areHyperplanesTubes> long long sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator nSetBegin, vector<vector<int>>& sumsOnHyperplanes) const;
+  template<typename Tubes, bool areHyperplanesTubes> void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int increasedDimensionId, vector<vector<int>>& sums) const;
+  template<typename Tubes, bool areHyperplanesTubes> void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionBegin, const unsigned int decreasedDimensionId, vector<vector<int>>& sums) const;
+
+  template<typename Tubes, bool areHyperplanesTubes> void sumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const; /* warning: sum cannot exceed numeric_limits<int>::max()! */
+  template<typename Tubes, bool areHyperplanesTubes> void minusSumOnPattern(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const; /* warning: sum cannot exceed numeric_limits<int>::max()! */
+  template<typename Tubes, bool areHyperplanesTubes> int sumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> int minusSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> void increaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> void decreaseSumsOnHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> int increaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> int decreaseSumsOnPatternAndHyperplanes(const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+
+  // Same as above on the hyperplane at hyperplaneIt
+  template<typename Tubes, bool areHyperplanesTubes> void sumOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
+  template<typename Tubes, bool areHyperplanesTubes> void minusSumOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
+  template<typename Tubes, bool areHyperplanesTubes> int sumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> int minusSumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> void increaseSumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> void decreaseSumsOnHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> int increaseSumsOnPatternAndHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
+  template<typename Tubes, bool areHyperplanesTubes> int decreaseSumsOnPatternAndHyperplane(const vector<AbstractData*>::const_iterator hyperplaneIt, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<vector<int>>::iterator sumsIt) const;
 };
 
 #endif /*TRIE_H_*/
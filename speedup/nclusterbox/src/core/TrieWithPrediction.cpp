@@ -10,218 +10,150 @@
 
 #include "TrieWithPrediction.h"
 
-#include "TubeWithPrediction.h"
-
-TrieWithPrediction::TrieWithPrediction(): hyperplanes()
+TrieWithPrediction::TrieWithPrediction(): strides(), tuplesWithPrediction()
 {
 }
 
-TrieWithPrediction::TrieWithPrediction(TrieWithPrediction&& otherTrieWithPrediction): hyperplanes(std::move(otherTrieWithPrediction.hyperplanes))
+TrieWithPrediction::TrieWithPrediction(TrieWithPrediction&& otherTrieWithPrediction): strides(std::move(otherTrieWithPrediction.strides)), tuplesWithPrediction(std::move(otherTrieWithPrediction.tuplesWithPrediction))
 {
 }
 
-TrieWithPrediction::TrieWithPrediction(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes()
+TrieWithPrediction::TrieWithPrediction(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): strides(), tuplesWithPrediction()
 {
-  unsigned int hyperplaneId = 0;
-  const unsigned int cardinality = *cardinalityIt;
-  hyperplanes.reserve(cardinality);
-  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
-  if (nextCardinalityIt + 1 == cardinalityEnd)
-    {
-      do
-	{
-	  hyperplanes.push_back(new TubeWithPrediction(*nextCardinalityIt));
-	}
-      while (++hyperplaneId != cardinality);
-      return;
-    }
-  do
-    {
-      hyperplanes.push_back(new TrieWithPrediction(nextCardinalityIt, cardinalityEnd));
-    }
-  while (++hyperplaneId != cardinality);
+  setStrides(cardinalityIt, cardinalityEnd);
+  // Every real membership is TupleWithPrediction's default membership until set with setTuple
+  tuplesWithPrediction.resize(strides.front() * *cardinalityIt);
 }
 
-TrieWithPrediction::TrieWithPrediction(vector<double>::const_iterator& membershipIt, const unsigned int unit, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): hyperplanes()
+TrieWithPrediction::TrieWithPrediction(vector<double>::const_iterator& membershipIt, const unsigned int unit, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd): strides(), tuplesWithPrediction()
 {
-  unsigned int hyperplaneId = 0;
-  const unsigned int cardinality = *cardinalityIt;
-  hyperplanes.reserve(cardinality);
-  const vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityIt + 1;
-  if (nextCardinalityIt + 1 == cardinalityEnd)
-    {
-      do
-	{
-	  hyperplanes.push_back(new TubeWithPrediction(membershipIt, *nextCardinalityIt, unit));
-	}
-      while (++hyperplaneId != cardinality);
-      return;
-    }
+  setStrides(cardinalityIt, cardinalityEnd);
+  // The memberships are in lexicographic order of the tuples
+  const unsigned long long nbOfTuples = strides.front() * *cardinalityIt;
+  tuplesWithPrediction.reserve(nbOfTuples);
+  const vector<double>::const_iterator membershipEnd = membershipIt + nbOfTuples;
   do
     {
-      hyperplanes.push_back(new TrieWithPrediction(membershipIt, unit, nextCardinalityIt, cardinalityEnd));
-    }
-  while (++hyperplaneId != cardinality);
-}
-
-TrieWithPrediction::~TrieWithPrediction()
-{
-  for (AbstractDataWithPrediction* hyperplane : hyperplanes)
-    {
-      delete hyperplane;
+      tuplesWithPrediction.emplace_back(unit * *membershipIt);
     }
+  while (++membershipIt != membershipEnd);
 }
 
 TrieWithPrediction& TrieWithPrediction::operator=(TrieWithPrediction&& otherTrieWithPrediction)
 {
-  hyperplanes = std::move(otherTrieWithPrediction.hyperplanes);
+  strides = std::move(otherTrieWithPrediction.strides);
+  tuplesWithPrediction = std::move(otherTrieWithPrediction.tuplesWithPrediction);
   return *this;
 }
 
-void TrieWithPrediction::setTuple(const vector<unsigned int>::const_iterator idIt, const int membership)
+void TrieWithPrediction::setStrides(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd)
 {
-  hyperplanes[*idIt]->setTuple(idIt + 1, membership);
+  strides.resize(cardinalityEnd - cardinalityIt);
+  vector<unsigned long long>::reverse_iterator strideRIt = strides.rbegin();
+  *strideRIt = 1;
+  for (vector<unsigned int>::const_iterator nextCardinalityIt = cardinalityEnd; --nextCardinalityIt != cardinalityIt; )
+    {
+      const unsigned long long stride = *strideRIt * *nextCardinalityIt;
+      *++strideRIt = stride;
+    }
 }
 
-void TrieWithPrediction::membershipSumOnSlice(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const
+template<typename T, typename F> void TrieWithPrediction::forEachTuple(T* const tuples, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<unsigned long long>::const_iterator strideIt, const vector<unsigned long long>::const_iterator lastStrideIt, F process)
 {
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
   const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
   vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
+  if (strideIt == lastStrideIt)
     {
-      hyperplanes[*idIt]->membershipSumOnSlice(nextDimensionIt, sum);
+      // Last dimension, whose stride is 1
+      do
+	{
+	  process(tuples[*idIt]);
+	}
+      while (++idIt != idEnd);
+      return;
     }
-  while (++idIt != idEnd);
-}
-
-int TrieWithPrediction::density(const vector<vector<unsigned int>>& nSet) const
-{
-  long long sum = 0;
-  vector<vector<unsigned int>>::const_iterator dimensionIt = ++nSet.begin();
-  const vector<unsigned int>::const_iterator idEnd = nSet.front().end();
-  vector<unsigned int>::const_iterator idIt = nSet.front().begin();
+  const unsigned long long stride = *strideIt;
+  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
+  const vector<unsigned long long>::const_iterator nextStrideIt = strideIt + 1;
   do
     {
-      int sumOnSlice = 0;
-      hyperplanes[*idIt]->membershipSumOnSlice(dimensionIt, sumOnSlice);
-      sum += sumOnSlice;
+      forEachTuple(tuples + *idIt * stride, nextDimensionIt, nextStrideIt, lastStrideIt, process);
     }
   while (++idIt != idEnd);
-  sum /= static_cast<long long>((dimensionIt - 1)->size());
-  const vector<vector<unsigned int>>::const_iterator dimensionEnd = nSet.end();
-  do
-    {
-      sum /= static_cast<long long>(dimensionIt->size());
-    }
-  while (++dimensionIt != dimensionEnd);
-  return sum;
 }
 
-void TrieWithPrediction::addFirstPatternToModel(const vector<vector<unsigned int>>& tuples, const int density)
+void TrieWithPrediction::setTuple(const vector<unsigned int>::const_iterator idIt, const int membership)
 {
-  addFirstPatternToModel(tuples.begin(), density);
+  unsigned long long index = 0;
+  vector<unsigned int>::const_iterator elementIt = idIt;
+  for (const unsigned long long stride : strides)
+    {
+      index += *elementIt++ * stride;
+    }
+  tuplesWithPrediction[index].setRealMembership(membership);
 }
 
-void TrieWithPrediction::addFirstPatternToModel(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int density)
+int TrieWithPrediction::density(const vector<vector<unsigned int>>& nSet) const
 {
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
+  long long sum = 0;
+  forEachTuple(tuplesWithPrediction.data(), nSet.begin(), strides.begin(), strides.end() - 1, [&sum](const TupleWithPrediction& tupleWithPrediction) {sum += tupleWithPrediction.getRealMembership();});
+  for (const vector<unsigned int>& dimension : nSet)
     {
-      hyperplanes[*idIt]->addFirstPatternToModel(nextDimensionIt, density);
+      sum /= static_cast<long long>(dimension.size());
     }
-  while (++idIt != idEnd);
+  return sum;
 }
 
-void TrieWithPrediction::addPatternToModel(const vector<vector<unsigned int>>& tuples, const int density)
+void TrieWithPrediction::addFirstPatternToModel(const vector<vector<unsigned int>>& tuples, const int density)
 {
-  addPatternToModel(tuples.begin(), density);
+  forEachTuple(tuplesWithPrediction.data(), tuples.begin(), strides.begin(), strides.end() - 1, [density](TupleWithPrediction& tupleWithPrediction) {tupleWithPrediction.setEstimatedMembership(density);});
 }
 
-void TrieWithPrediction::addPatternToModel(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int density)
+void TrieWithPrediction::addPatternToModel(const vector<vector<unsigned int>>& tuples, const int density)
 {
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
-    {
-      hyperplanes[*idIt]->addPatternToModel(nextDimensionIt, density);
-    }
-  while (++idIt != idEnd);
+  forEachTuple(tuplesWithPrediction.data(), tuples.begin(), strides.begin(), strides.end() - 1, [density](TupleWithPrediction& tupleWithPrediction) {tupleWithPrediction.addPrediction(density);});
 }
 
 long long TrieWithPrediction::deltaOfRSSVariationAdding(const vector<vector<unsigned int>>& tuples, const int minDensityOfSelectedAndUpdated) const
 {
   long long delta = 0;
-  deltaOfRSSVariationAdding(tuples.begin(), minDensityOfSelectedAndUpdated, delta);
+  forEachTuple(tuplesWithPrediction.data(), tuples.begin(), strides.begin(), strides.end() - 1, [minDensityOfSelectedAndUpdated, &delta](const TupleWithPrediction& tupleWithPrediction)
+  {
+    if (tupleWithPrediction.isGreaterThanDensest(minDensityOfSelectedAndUpdated))
+      {
+	delta += tupleWithPrediction.squaredResidualVariationFromDensest(minDensityOfSelectedAndUpdated);
+      }
+  });
   return delta;
 }
 
-void TrieWithPrediction::deltaOfRSSVariationAdding(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int minDensityOfSelectedAndUpdated, long long& delta) const
-{
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
-    {
-      hyperplanes[*idIt]->deltaOfRSSVariationAdding(nextDimensionIt, minDensityOfSelectedAndUpdated, delta);
-    }
-  while (++idIt != idEnd);
-}
-
-long long TrieWithPrediction::deltaOfRSSVariationRemovingIfSparserSelected(const vector<vector<unsigned int>> tuples, const int updatedDensity, const int selectedDensity) const
+long long TrieWithPrediction::deltaOfRSSVariationRemovingIfSparserSelected(const vector<vector<unsigned int>>& tuples, const int updatedDensity, const int selectedDensity) const
 {
   long long delta = 0;
-  deltaOfRSSVariationRemovingIfSparserSelected(tuples.begin(), updatedDensity, selectedDensity, delta);
+  forEachTuple(tuplesWithPrediction.data(), tuples.begin(), strides.begin(), strides.end() - 1, [updatedDensity, selectedDensity, &delta](const TupleWithPrediction& tupleWithPrediction)
+  {
+    if (tupleWithPrediction.isDensest(updatedDensity) && tupleWithPrediction.isGreaterThanSecondDensest(selectedDensity))
+      {
+	delta += tupleWithPrediction.squaredResidualVariationFromSecondDensest(selectedDensity);
+      }
+  });
   return delta;
 }
 
-void TrieWithPrediction::deltaOfRSSVariationRemovingIfSparserSelected(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int updatedDensity, const int selectedDensity, long long& delta) const
-{
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
-    {
-      hyperplanes[*idIt]->deltaOfRSSVariationRemovingIfSparserSelected(nextDimensionIt, updatedDensity, selectedDensity, delta);
-    }
-  while (++idIt != idEnd);
-}
-
-long long TrieWithPrediction::deltaOfRSSVariationRemovingIfDenserSelected(const vector<vector<unsigned int>> tuples, const int updatedDensity) const
+long long TrieWithPrediction::deltaOfRSSVariationRemovingIfDenserSelected(const vector<vector<unsigned int>>& tuples, const int updatedDensity) const
 {
   long long delta = 0;
-  deltaOfRSSVariationRemovingIfDenserSelected(tuples.begin(), updatedDensity, delta);
+  forEachTuple(tuplesWithPrediction.data(), tuples.begin(), strides.begin(), strides.end() - 1, [updatedDensity, &delta](const TupleWithPrediction& tupleWithPrediction)
+  {
+    if (tupleWithPrediction.isDensest(updatedDensity))
+      {
+	delta += tupleWithPrediction.squaredResidualVariationFromSecondDensest(updatedDensity);
+      }
+  });
   return delta;
 }
 
-void TrieWithPrediction::deltaOfRSSVariationRemovingIfDenserSelected(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int updatedDensity, long long& delta) const
-{
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
-    {
-      hyperplanes[*idIt]->deltaOfRSSVariationRemovingIfDenserSelected(nextDimensionIt, updatedDensity, delta);
-    }
-  while (++idIt != idEnd);
-}
-
 void TrieWithPrediction::reset(const vector<vector<unsigned int>>& tuples)
 {
-  reset(tuples.begin());
-}
-
-void TrieWithPrediction::reset(const vector<vector<unsigned int>>::const_iterator dimensionIt)
-{
-  const vector<vector<unsigned int>>::const_iterator nextDimensionIt = dimensionIt + 1;
-  const vector<unsigned int>::const_iterator idEnd = dimensionIt->end();
-  vector<unsigned int>::const_iterator idIt = dimensionIt->begin();
-  do
-    {
-      hyperplanes[*idIt]->reset(nextDimensionIt);
-    }
-  while (++idIt != idEnd);
+  forEachTuple(tuplesWithPrediction.data(), tuples.begin(), strides.begin(), strides.end() - 1, [](TupleWithPrediction& tupleWithPrediction) {tupleWithPrediction.reset();});
 }
@@ -11,9 +11,14 @@
 #ifndef TRIE_WITH_PREDICTION_H_
 #define TRIE_WITH_PREDICTION_H_
 
-#include "AbstractDataWithPrediction.h"
+#include <vector>
 
-class TrieWithPrediction final : public AbstractDataWithPrediction
+#include "TupleWithPrediction.h"
+
+using namespace std;
+
+/* Complete trie of the tuples of the projected tensor, with their predictions.  Since it is complete, it is stored without any pointer (as FlatTrie): the tuples are packed one after the other in lexicographic order, the tuple (id_1, ..., id_n) being at index id_1 * strides[0] + ... + id_n * strides[n - 1] */
+class TrieWithPrediction
 {
  public:
   TrieWithPrediction();
@@ -21,29 +26,24 @@ class TrieWithPrediction final : public AbstractDataWithPrediction
   TrieWithPrediction(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd);
   TrieWithPrediction(vector<double>::const_iterator& membershipIt, const unsigned int unit, const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd);
 
-  ~TrieWithPrediction();
-
   TrieWithPrediction& operator=(TrieWithPrediction&& otherTrieWithPrediction);
 
   void setTuple(const vector<unsigned int>::const_iterator idIt, const int membership);
 
   int density(const vector<vector<unsigned int>>& nSet) const;
-  void membershipSumOnSlice(const vector<vector<unsigned int>>::const_iterator dimensionIt, int& sum) const;
   void addFirstPatternToModel(const vector<vector<unsigned int>>& tuples, const int density);
-  void addFirstPatternToModel(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int density);
   void addPatternToModel(const vector<vector<unsigned int>>& tuples, const int density);
-  void addPatternToModel(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int density);
   long long deltaOfRSSVariationAdding(const vector<vector<unsigned int>>& tuples, const int minDensityOfSelectedAndUpdated) const;
-  void deltaOfRSSVariationAdding(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int minDensityOfSelectedAndUpdated, long long& delta) const;
-  long long deltaOfRSSVariationRemovingIfSparserSelected(const vector<vector<unsigned int>> tuples, const int updatedDensity, const int selectedDensity) const;
-  void deltaOfRSSVariationRemovingIfSparserSelected(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int updatedDensity, const int selectedDensity, long long& delta) const;
-  long long deltaOfRSSVariationRemovingIfDenserSelected(const vector<vector<unsigned int>> tuples, const int updatedDensity) const;
-  void deltaOfRSSVariationRemovingIfDenserSelected(const vector<vector<unsigned int>>::const_iterator dimensionIt, const int updatedDensity, long long& delta) const;
+  long long deltaOfRSSVariationRemovingIfSparserSelected(const vector<vector<unsigned int>>& tuples, const int updatedDensity, const int selectedDensity) const;
+  long long deltaOfRSSVariationRemovingIfDenserSelected(const vector<vector<unsigned int>>& tuples, const int updatedDensity) const;
   void reset(const vector<vector<unsigned int>>& tuples);
-  void reset(const vector<vector<unsigned int>>::const_iterator dimensionIt);
 
  private:
-  vector<AbstractDataWithPrediction*> hyperplanes;
+  vector<unsigned long long> strides; /* strides[d] is the product of the cardinalities of the dimensions after d */
+  vector<TupleWithPrediction> tuplesWithPrediction;
+
+  void setStrides(const vector<unsigned int>::const_iterator cardinalityIt, const vector<unsigned int>::const_iterator cardinalityEnd);
+  template<typename T, typename F> static void forEachTuple(T* const tuples, const vector<vector<unsigned int>>::const_iterator dimensionIt, const vector<unsigned long long>::const_iterator strideIt, const vector<unsigned long long>::const_iterator lastStrideIt, F process); /* calls process on every tuple in the n-set starting at dimensionIt, tuples pointing to the first tuple of the slice the previous dimensions fix */
 };
 
 #endif /*TRIE_WITH_PREDICTION_H_*/
@@ -18,21 +18,44 @@
 #include "../utilities/NoInputException.h"
 #include "../utilities/DataFormatException.h"
 
-TupleFileReader::TupleFileReader(const char* tensorFileNameParam, const char* inputDimensionSeparatorParam, const char* inputElementSeparatorParam): tensorFileName(tensorFileNameParam), tensorStream(nullptr), tensorFile(), inputDimensionSeparator(inputDimensionSeparatorParam), inputElementSeparator(inputElementSeparatorParam), lineNb(0), ids2Labels(), labels2Ids(), nSet(), tupleIts()
+TupleFileReader::TupleFileReader(const char* tensorFileNameParam, const char* inputDimensionSeparatorParam, const char* inputElementSeparatorParam): tensorFileName(tensorFileNameParam), tensorStream(nullptr), tensorFile(), decompressingStreamBuffer(DecompressingStreamBuffer::open(tensorFileNameParam)), inputDimensionSeparator(inputDimensionSeparatorParam), inputElementSeparator(inputElementSeparatorParam), lineNb(0), ids2Labels(), labels2Ids(), nSet(), tupleIts()
 {
-   if (tensorFileName == "-")
+  if (decompressingStreamBuffer)
+    {
+      tensorStream.rdbuf(decompressingStreamBuffer);
+      // Have the stream rethrow the NoInputException of a corrupted compressed file
+      tensorStream.exceptions(ios::badbit);
+    }
+  else
+    {
+      if (tensorFileName == "-")
+	{
+	  tensorStream.rdbuf(cin.rdbuf());
+	}
+      else
+	{
+	  tensorFile.open(tensorFileNameParam);
+	  if (!tensorFile)
+	    {
+	      throw NoInputException(tensorFileNameParam);
+	    }
+	  tensorStream.rdbuf(tensorFile.rdbuf());
+	}
+    }
+  try
     {
-      tensorStream.rdbuf(cin.rdbuf());
       init();
-      return;
     }
-   tensorFile.open(tensorFileNameParam);
-   if (!tensorFile)
+  catch (...)
     {
-      throw NoInputException(tensorFileNameParam);
+      delete decompressingStreamBuffer;
+      throw;
     }
-  tensorStream.rdbuf(tensorFile.rdbuf());
-  init();
+}
+
+TupleFileReader::~TupleFileReader()
+{
+  delete decompressingStreamBuffer;
 }
 
 void TupleFileReader::init()
@@ -65,12 +88,12 @@ void TupleFileReader::init()
 #endif
 }
 
-vector<FuzzyTuple> TupleFileReader::read()
+FuzzyTupleArray TupleFileReader::read()
 {
   const vector<vector<unsigned int>::const_iterator>::iterator tupleItsEnd = tupleIts.end();
-  for (vector<FuzzyTuple> fuzzyTuples; ; )
+  for (FuzzyTupleArray fuzzyTuples(tupleIts.size()); ; )
     {
-      fuzzyTuples.emplace_back(tupleIts, 1.);
+      fuzzyTuples.push_back(tupleIts);
       // Advance tuple in nSet, little-endian-like
       vector<vector<unsigned int>::const_iterator>::iterator tupleItsIt = tupleIts.begin();
       for (vector<vector<unsigned int>>::const_iterator nSetIt = nSet.begin(); nSetIt != nSet.end() && ++*tupleItsIt == nSetIt->end(); ++nSetIt)
@@ -85,9 +108,7 @@ vector<FuzzyTuple> TupleFileReader::read()
 	      if (tensorStream.eof())
 		{
 		  tensorFile.close();
-		  fuzzyTuples.shrink_to_fit();
-		  stable_sort(fuzzyTuples.begin(), fuzzyTuples.end());
-		  fuzzyTuples.erase(unique(fuzzyTuples.begin(), fuzzyTuples.end()), fuzzyTuples.end());
+		  fuzzyTuples.sortAndRemoveDuplicates(ids2Labels);
 		  return fuzzyTuples;
 		}
 	      ++lineNb;
@@ -15,16 +15,21 @@
 #include <fstream>
 #include <boost/tokenizer.hpp>
 
-#include "FuzzyTuple.h"
+#include "FuzzyTupleArray.h"
+#include "DecompressingStreamBuffer.h"
 
 using namespace boost;
 
 class TupleFileReader
 {
  public:
+  TupleFileReader(const TupleFileReader& otherTupleFileReader) = delete;
   TupleFileReader(const char* tensorFileName, const char* inputDimensionSeparator, const char* inputElementSeparator);
+  ~TupleFileReader();
 
-  vector<FuzzyTuple> read(); /* returns the unique fuzzy tuples, ordered by FuzzyTuple::operator< */
+  TupleFileReader& operator=(const TupleFileReader& otherTupleFileReader) = delete;
+
+  FuzzyTupleArray read(); /* returns the unique tuples, in decreasing lexicographic order */
 
   vector<vector<string>>& getIds2Labels();
 
@@ -32,6 +37,7 @@ class TupleFileReader
   const string tensorFileName;
   istream tensorStream;
   ifstream tensorFile;
+  DecompressingStreamBuffer* decompressingStreamBuffer; /* nullptr unless the tensor file is compressed or a pipe */
   const char_separator<char> inputDimensionSeparator;
   const char_separator<char> inputElementSeparator;
   unsigned int lineNb;
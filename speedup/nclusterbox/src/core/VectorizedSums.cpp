@@ -0,0 +1,202 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "VectorizedSums.h"
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+const VectorizedSums::InstructionSet VectorizedSums::instructionSet = VectorizedSums::getInstructionSet();
+
+static void addScalar(const int* memberships, const size_t size, int* sums)
+{
+  for (size_t elementId = 0; elementId != size; ++elementId)
+    {
+      sums[elementId] += memberships[elementId];
+    }
+}
+
+static void subtractScalar(const int* memberships, const size_t size, int* sums)
+{
+  for (size_t elementId = 0; elementId != size; ++elementId)
+    {
+      sums[elementId] -= memberships[elementId];
+    }
+}
+
+static void incrementScalar(const unsigned long long* words, const size_t size, int* sums)
+{
+  const unsigned long long* wordEnd = words + (size + 63) / 64;
+  for (const unsigned long long* wordIt = words; wordIt != wordEnd; ++wordIt)
+    {
+      int* wordSums = sums + 64 * (wordIt - words);
+      for (unsigned long long word = *wordIt; word; word &= word - 1)
+	{
+	  ++wordSums[__builtin_ctzll(word)];
+	}
+    }
+}
+
+#ifdef __x86_64__
+__attribute__((target("avx2"))) static void addAvx2(const int* memberships, const size_t size, int* sums)
+{
+  size_t elementId = 0;
+  for (const size_t vectorEnd = size & ~static_cast<size_t>(7); elementId != vectorEnd; elementId += 8)
+    {
+      __m256i* sumVector = reinterpret_cast<__m256i*>(sums + elementId);
+      _mm256_storeu_si256(sumVector, _mm256_add_epi32(_mm256_loadu_si256(sumVector), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(memberships + elementId))));
+    }
+  addScalar(memberships + elementId, size - elementId, sums + elementId);
+}
+
+__attribute__((target("avx2"))) static void subtractAvx2(const int* memberships, const size_t size, int* sums)
+{
+  size_t elementId = 0;
+  for (const size_t vectorEnd = size & ~static_cast<size_t>(7); elementId != vectorEnd; elementId += 8)
+    {
+      __m256i* sumVector = reinterpret_cast<__m256i*>(sums + elementId);
+      _mm256_storeu_si256(sumVector, _mm256_sub_epi32(_mm256_loadu_si256(sumVector), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(memberships + elementId))));
+    }
+  subtractScalar(memberships + elementId, size - elementId, sums + elementId);
+}
+
+__attribute__((target("avx2"))) static void incrementAvx2(const unsigned long long* words, const size_t size, int* sums)
+{
+  // Eight bits at a time: every bit becomes a lane of -1 (set) or 0, which is subtracted
+  const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const size_t nbOfFullBytes = size / 8;
+  for (size_t byteId = 0; byteId != nbOfFullBytes; ++byteId)
+    {
+      const int byte = words[byteId / 8] >> byteId % 8 * 8 & 255;
+      if (byte)
+	{
+	  __m256i* sumVector = reinterpret_cast<__m256i*>(sums + 8 * byteId);
+	  _mm256_storeu_si256(sumVector, _mm256_sub_epi32(_mm256_loadu_si256(sumVector), _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(byte), bits), bits)));
+	}
+    }
+  for (size_t elementId = 8 * nbOfFullBytes; elementId != size; ++elementId)
+    {
+      sums[elementId] += words[elementId / 64] >> elementId % 64 & 1;
+    }
+}
+
+__attribute__((target("avx512f"))) static void addAvx512(const int* memberships, const size_t size, int* sums)
+{
+  size_t elementId = 0;
+  for (const size_t vectorEnd = size & ~static_cast<size_t>(15); elementId != vectorEnd; elementId += 16)
+    {
+      _mm512_storeu_si512(sums + elementId, _mm512_add_epi32(_mm512_loadu_si512(sums + elementId), _mm512_loadu_si512(memberships + elementId)));
+    }
+  if (elementId != size)
+    {
+      const __mmask16 tail = (1u << (size - elementId)) - 1;
+      _mm512_mask_storeu_epi32(sums + elementId, tail, _mm512_add_epi32(_mm512_maskz_loadu_epi32(tail, sums + elementId), _mm512_maskz_loadu_epi32(tail, memberships + elementId)));
+    }
+}
+
+__attribute__((target("avx512f"))) static void subtractAvx512(const int* memberships, const size_t size, int* sums)
+{
+  size_t elementId = 0;
+  for (const size_t vectorEnd = size & ~static_cast<size_t>(15); elementId != vectorEnd; elementId += 16)
+    {
+      _mm512_storeu_si512(sums + elementId, _mm512_sub_epi32(_mm512_loadu_si512(sums + elementId), _mm512_loadu_si512(memberships + elementId)));
+    }
+  if (elementId != size)
+    {
+      const __mmask16 tail = (1u << (size - elementId)) - 1;
+      _mm512_mask_storeu_epi32(sums + elementId, tail, _mm512_sub_epi32(_mm512_maskz_loadu_epi32(tail, sums + elementId), _mm512_maskz_loadu_epi32(tail, memberships + elementId)));
+    }
+}
+
+__attribute__((target("avx512f"))) static void incrementAvx512(const unsigned long long* words, const size_t size, int* sums)
+{
+  // Sixteen bits at a time, which directly are the mask of the lanes to increment (the bits after size are unset)
+  const __m512i one = _mm512_set1_epi32(1);
+  const size_t nbOfChunks = (size + 15) / 16;
+  for (size_t chunkId = 0; chunkId != nbOfChunks; ++chunkId)
+    {
+      const __mmask16 chunk = words[chunkId / 4] >> chunkId % 4 * 16;
+      if (chunk)
+	{
+	  int* chunkSums = sums + 16 * chunkId;
+	  _mm512_mask_storeu_epi32(chunkSums, chunk, _mm512_add_epi32(_mm512_maskz_loadu_epi32(chunk, chunkSums), one));
+	}
+    }
+}
+
+#endif
+
+VectorizedSums::InstructionSet VectorizedSums::getInstructionSet()
+{
+#ifdef __x86_64__
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    {
+      return avx512;
+    }
+  if (__builtin_cpu_supports("avx2"))
+    {
+      return avx2;
+    }
+#endif
+  return scalar;
+}
+
+void VectorizedSums::add(const int* memberships, const size_t size, int* sums)
+{
+#ifdef __x86_64__
+  if (instructionSet == avx512)
+    {
+      addAvx512(memberships, size, sums);
+      return;
+    }
+  if (instructionSet == avx2)
+    {
+      addAvx2(memberships, size, sums);
+      return;
+    }
+#endif
+  addScalar(memberships, size, sums);
+}
+
+void VectorizedSums::subtract(const int* memberships, const size_t size, int* sums)
+{
+#ifdef __x86_64__
+  if (instructionSet == avx512)
+    {
+      subtractAvx512(memberships, size, sums);
+      return;
+    }
+  if (instructionSet == avx2)
+    {
+      subtractAvx2(memberships, size, sums);
+      return;
+    }
+#endif
+  subtractScalar(memberships, size, sums);
+}
+
+void VectorizedSums::increment(const unsigned long long* words, const size_t size, int* sums)
+{
+#ifdef __x86_64__
+  if (instructionSet == avx512)
+    {
+      incrementAvx512(words, size, sums);
+      return;
+    }
+  if (instructionSet == avx2)
+    {
+      incrementAvx2(words, size, sums);
+      return;
+    }
+#endif
+  incrementScalar(words, size, sums);
+}
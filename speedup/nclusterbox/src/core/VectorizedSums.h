@@ -0,0 +1,34 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef VECTORIZED_SUMS_H_
+#define VECTORIZED_SUMS_H_
+
+#include <cstddef>
+
+using namespace std;
+
+/* Loops over dense tubes, with AVX-512 or AVX2 instructions if the processor (asked through CPUID at startup) has them; the integer results are those of the scalar loops */
+class VectorizedSums
+{
+ public:
+  static void add(const int* memberships, const size_t size, int* sums); /* adds memberships[i] to sums[i], for i in [0, size) */
+  static void subtract(const int* memberships, const size_t size, int* sums); /* subtracts memberships[i] from sums[i], for i in [0, size) */
+  static void increment(const unsigned long long* words, const size_t size, int* sums); /* increments sums[i], for i in [0, size) such that bit i of words is set */
+
+ private:
+  enum InstructionSet { scalar, avx2, avx512 };
+
+  static const InstructionSet instructionSet;
+
+  static InstructionSet getInstructionSet();
+};
+
+#endif /*VECTORIZED_SUMS_H_*/
@@ -0,0 +1,68 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "VisitedBloomFilter.h"
+
+#if REMEMBER == 1
+#include <cmath>
+
+// Odd multipliers choosing, from the end of a fingerprint, the bit to set in each word of a block
+static const unsigned long long salts[8] = {0x47b6137b44974d91ULL, 0x8824ad5ba2b7289dULL, 0x705495c72df1424bULL, 0x9efc49475c6bfb31ULL, 0xa2b7289d8824ad5bULL, 0x2df1424b705495c7ULL, 0x5c6bfb319efc4947ULL, 0x44974d9147b6137bULL};
+
+vector<VisitedBloomFilter::Block> VisitedBloomFilter::blocks;
+double VisitedBloomFilter::falsePositiveProbabilityWhenCleared = 0;
+
+void VisitedBloomFilter::init(const unsigned long long nbOfBytes)
+{
+  const unsigned long long nbOfBlocks = nbOfBytes / sizeof(Block);
+  blocks = vector<Block>(nbOfBlocks ? nbOfBlocks : 1);
+}
+
+bool VisitedBloomFilter::visited(const unsigned long long fingerprintBegin, const unsigned long long fingerprintEnd)
+{
+  Block& block = blocks[fingerprintBegin % blocks.size()];
+  bool isPresent = true;
+  const unsigned long long* saltIt = salts;
+  for (atomic<unsigned long long>& word : block.words)
+    {
+      const unsigned long long bit = 1ULL << (fingerprintEnd * *saltIt++ >> 58);
+      if (!(word.load(memory_order_relaxed) & bit))
+	{
+	  word.fetch_or(bit, memory_order_relaxed);
+	  isPresent = false;
+	}
+    }
+  return isPresent;
+}
+
+double VisitedBloomFilter::getFalsePositiveProbability()
+{
+  if (blocks.empty())
+    {
+      return falsePositiveProbabilityWhenCleared;
+    }
+  unsigned long long nbOfSetBits = 0;
+  for (const Block& block : blocks)
+    {
+      for (const atomic<unsigned long long>& word : block.words)
+	{
+	  nbOfSetBits += __builtin_popcountll(word.load(memory_order_relaxed));
+	}
+    }
+  return pow(static_cast<double>(nbOfSetBits) / (blocks.size() * 512), 8);
+}
+
+void VisitedBloomFilter::clear()
+{
+  falsePositiveProbabilityWhenCleared = getFalsePositiveProbability();
+  blocks.clear();
+  blocks.shrink_to_fit();
+}
+#endif
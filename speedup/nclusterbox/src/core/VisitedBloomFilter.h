@@ -0,0 +1,42 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef VISITED_BLOOM_FILTER_H_
+#define VISITED_BLOOM_FILTER_H_
+
+#include "../../Parameters.h"
+
+#if REMEMBER == 1
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+/* Concurrent split-block Bloom filter over 128-bit fingerprints of n-sets: every fingerprint sets one bit in each of the eight words of one cache line; a fingerprint may be wrongly considered present (false positive), never wrongly absent */
+class VisitedBloomFilter
+{
+ public:
+  static void init(const unsigned long long nbOfBytes);
+  static bool visited(const unsigned long long fingerprintBegin, const unsigned long long fingerprintEnd); /* inserts the fingerprint and returns whether it was (probably) present */
+  static double getFalsePositiveProbability(); /* estimated from the proportion of set bits, before clear() if it was called */
+  static void clear();
+
+ private:
+  struct alignas(64) Block
+  {
+    atomic<unsigned long long> words[8];
+  };
+
+  static vector<Block> blocks;
+  static double falsePositiveProbabilityWhenCleared;
+};
+#endif
+
+#endif /*VISITED_BLOOM_FILTER_H_*/
@@ -0,0 +1,132 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "VisitedFingerprints.h"
+
+#if REMEMBER == 1
+
+// Number of shards, a power of two
+static const unsigned int nbOfShards = 256;
+// Initial number of slots in a shard, a power of two
+static const unsigned long long initialNbOfSlotsPerShard = 32;
+
+vector<VisitedFingerprints::Shard> VisitedFingerprints::shards;
+atomic<unsigned long long> VisitedFingerprints::nbOfAvailableBytes(0);
+unsigned long long VisitedFingerprints::nbOfRefusedInsertionsWhenCleared = 0;
+unsigned int VisitedFingerprints::nbOfBitsForShardId;
+
+VisitedFingerprints::Shard::Shard(): lock(), slots(initialNbOfSlotsPerShard, {0, 0}), nbOfFreeSlots(initialNbOfSlotsPerShard / 4 * 3), nbOfRefusedInsertions(0)
+{
+}
+
+bool VisitedFingerprints::Shard::grow()
+{
+  // Reserving the additional memory, half of the new slots
+  const unsigned long long nbOfAdditionalBytes = slots.size() * sizeof(Slot);
+  unsigned long long nbOfAvailableBytesBefore = nbOfAvailableBytes.load(memory_order_relaxed);
+  do
+    {
+      if (nbOfAvailableBytesBefore < nbOfAdditionalBytes)
+	{
+	  return false;
+	}
+    }
+  while (!nbOfAvailableBytes.compare_exchange_weak(nbOfAvailableBytesBefore, nbOfAvailableBytesBefore - nbOfAdditionalBytes, memory_order_relaxed));
+  vector<Slot> newSlots(2 * slots.size(), {0, 0});
+  for (const Slot& slot : slots)
+    {
+      if (slot.fingerprintBegin)
+	{
+	  insert(slot.fingerprintBegin, slot.fingerprintEnd, newSlots);
+	}
+    }
+  slots.swap(newSlots);
+  nbOfFreeSlots += slots.size() / 8 * 3;
+  return true;
+}
+
+void VisitedFingerprints::init(const unsigned long long nbOfBytes)
+{
+  nbOfBitsForShardId = 0;
+  while (1u << nbOfBitsForShardId != nbOfShards)
+    {
+      ++nbOfBitsForShardId;
+    }
+  shards = vector<Shard>(nbOfShards);
+  // The initial slots are not counted: they only take some hundreds of kB
+  nbOfAvailableBytes = nbOfBytes;
+}
+
+void VisitedFingerprints::insert(const unsigned long long fingerprintBegin, const unsigned long long fingerprintEnd, vector<Slot>& slots)
+{
+  const unsigned long long slotIdMask = slots.size() - 1;
+  unsigned long long slotId = fingerprintBegin & slotIdMask;
+  while (slots[slotId].fingerprintBegin)
+    {
+      slotId = (slotId + 1) & slotIdMask;
+    }
+  slots[slotId] = {fingerprintBegin, fingerprintEnd};
+}
+
+bool VisitedFingerprints::visited(unsigned long long fingerprintBegin, unsigned long long fingerprintEnd)
+{
+  // 0 marks empty slots
+  if (!fingerprintBegin)
+    {
+      fingerprintBegin = 1;
+    }
+  if (!fingerprintEnd)
+    {
+      fingerprintEnd = 1;
+    }
+  Shard& shard = shards[fingerprintBegin >> (64 - nbOfBitsForShardId)];
+  const lock_guard<mutex> lock(shard.lock);
+  const unsigned long long slotIdMask = shard.slots.size() - 1;
+  for (unsigned long long slotId = fingerprintBegin & slotIdMask; shard.slots[slotId].fingerprintBegin; slotId = (slotId + 1) & slotIdMask)
+    {
+      const Slot& slot = shard.slots[slotId];
+      if (slot.fingerprintBegin == fingerprintBegin && slot.fingerprintEnd == fingerprintEnd)
+	{
+	  return true;
+	}
+    }
+  if (!shard.nbOfFreeSlots && !shard.grow())
+    {
+      // Shard full: fingerprint absent and not stored
+      ++shard.nbOfRefusedInsertions;
+      return false;
+    }
+  insert(fingerprintBegin, fingerprintEnd, shard.slots);
+  --shard.nbOfFreeSlots;
+  return false;
+}
+
+unsigned long long VisitedFingerprints::getNbOfRefusedInsertions()
+{
+  if (shards.empty())
+    {
+      return nbOfRefusedInsertionsWhenCleared;
+    }
+  unsigned long long nbOfRefusedInsertions = 0;
+  for (Shard& shard : shards)
+    {
+      const lock_guard<mutex> lock(shard.lock);
+      nbOfRefusedInsertions += shard.nbOfRefusedInsertions;
+    }
+  return nbOfRefusedInsertions;
+}
+
+void VisitedFingerprints::clear()
+{
+  nbOfRefusedInsertionsWhenCleared = getNbOfRefusedInsertions();
+  shards.clear();
+  shards.shrink_to_fit();
+}
+#endif
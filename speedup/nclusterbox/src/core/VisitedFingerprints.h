@@ -0,0 +1,61 @@
+// Copyright 2023 Loïc Cerf (lcerf@dcc.ufmg.br)
+
+// This file is part of nclusterbox.
+
+// nclusterbox is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+
+// nclusterbox is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License along with nclusterbox.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef VISITED_FINGERPRINTS_H_
+#define VISITED_FINGERPRINTS_H_
+
+#include "../../Parameters.h"
+
+#if REMEMBER == 1
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+/* Concurrent open-addressing hash table of 128-bit fingerprints of n-sets, sharded by the most significant bits of the fingerprints; every shard is protected by its own lock, starts small and doubles (rehashing its fingerprints) when three quarters full, as long as the memory of all the shards stays within a budget; beyond, a full shard stops storing fingerprints (the n-sets they identify are then considered never visited) and counts the refused insertions */
+class VisitedFingerprints
+{
+ public:
+  static void init(const unsigned long long nbOfBytes);
+  static bool visited(unsigned long long fingerprintBegin, unsigned long long fingerprintEnd); /* inserts the fingerprint if absent and returns whether it was present */
+  static unsigned long long getNbOfRefusedInsertions(); /* in full shards, before clear() if it was called */
+  static void clear();
+
+ private:
+  /* 0 means an empty slot in both words */
+  struct Slot
+  {
+    unsigned long long fingerprintBegin;
+    unsigned long long fingerprintEnd;
+  };
+
+  struct alignas(64) Shard
+  {
+    mutex lock;
+    vector<Slot> slots;
+    unsigned long long nbOfFreeSlots; /* before the shard grows or, if it cannot, is considered full */
+    unsigned long long nbOfRefusedInsertions; /* since the shard is full */
+
+    Shard();
+
+    bool grow(); /* false if that would exceed the budget */
+  };
+
+  static vector<Shard> shards;
+  static atomic<unsigned long long> nbOfAvailableBytes; /* for the shards to grow */
+  static unsigned long long nbOfRefusedInsertionsWhenCleared;
+  static unsigned int nbOfBitsForShardId;
+
+  static void insert(const unsigned long long fingerprintBegin, const unsigned long long fingerprintEnd, vector<Slot>& slots); /* the fingerprint is absent and slots has an empty slot */
+};
+#endif
+
+#endif /*VISITED_FINGERPRINTS_H_*/
@@ -10,18 +10,19 @@
 
 #include "PresentVisitedPatternLeaf.h"
 
-vector<unsigned int> VisitedPatterns::elementOffsets;
-vector<unsigned int> VisitedPatterns::tupleOffsets;
-
 VisitedPatterns::~VisitedPatterns()
 {
 }
 
 #if REMEMBER == 1
-vector<pair<mutex, unordered_set<vector<unsigned int>, boost::hash<vector<unsigned int>>>>> VisitedPatterns::firstTuples;
+bool VisitedPatterns::isFiltered;
 #else  // REMEMBER == 2
 VisitedPatterns VisitedPatterns::presentWithNoExtension;
 
+vector<unsigned int> VisitedPatterns::elementOffsets;
+
+vector<unsigned int> VisitedPatterns::tupleOffsets;
+
 vector<pair<mutex, VisitedPatterns*>> VisitedPatterns::firstTuples;
 
 bool VisitedPatterns::isPresent() const
@@ -45,26 +46,42 @@ void VisitedPatterns::deepDelete()
 }
 #endif
 
-void VisitedPatterns::init(const vector<unsigned int>& cardinalities)
+void VisitedPatterns::init(const vector<unsigned int>& cardinalities, const unsigned long long nbOfBytes, const bool isFilteredParam)
 {
+#if REMEMBER == 1
+  isFiltered = isFilteredParam;
+  if (isFiltered)
+    {
+      VisitedBloomFilter::init(nbOfBytes);
+      return;
+    }
+  VisitedFingerprints::init(nbOfBytes);
+#else  // REMEMBER == 2
   const vector<unsigned int>::const_iterator lastCardinalityIt = --cardinalities.end();
   vector<unsigned int>::const_iterator cardinalityIt = cardinalities.begin();
-  tupleOffsets.reserve(distance(cardinalityIt, lastCardinalityIt));
   elementOffsets.reserve(distance(cardinalityIt, lastCardinalityIt));
-  tupleOffsets.push_back(*cardinalityIt);
   elementOffsets.push_back(*cardinalityIt);
+  tupleOffsets.reserve(distance(cardinalityIt, lastCardinalityIt));
+  tupleOffsets.push_back(*cardinalityIt);
   while (++cardinalityIt != lastCardinalityIt)
     {
       tupleOffsets.push_back(*cardinalityIt * tupleOffsets.back());
       elementOffsets.push_back(*cardinalityIt + elementOffsets.back());
     }
-#if REMEMBER == 1
-  firstTuples = vector<pair<mutex, unordered_set<vector<unsigned int>, boost::hash<vector<unsigned int>>>>>(tupleOffsets.back());
-#else  // REMEMBER == 2
   firstTuples = vector<pair<mutex, VisitedPatterns*>>(tupleOffsets.back());
 #endif
 }
 
+#if REMEMBER == 1
+bool VisitedPatterns::visited(const NSetFingerprint& fingerprint)
+{
+  if (isFiltered)
+    {
+      return VisitedBloomFilter::visited(fingerprint.getBegin(), fingerprint.getEnd());
+    }
+  return VisitedFingerprints::visited(fingerprint.getBegin(), fingerprint.getEnd());
+}
+#else  // REMEMBER == 2
 bool VisitedPatterns::visited(const vector<vector<unsigned int>>& nSet)
 {
   vector<vector<unsigned int>>::const_iterator nSetEnd = nSet.end();
@@ -77,7 +94,9 @@ bool VisitedPatterns::visited(const vector<vector<unsigned int>>& nSet)
     }
   while (++nSetIt != nSetEnd);
   nSetIt = nSet.begin();
-  vector<unsigned int> flatNSet;
+  // Reusing the flat n-set of the previous call of the thread: visiting a pattern allocates memory only if it must be stored
+  static thread_local vector<unsigned int> flatNSet;
+  flatNSet.clear();
   flatNSet.reserve(nbOfElementsInNSet - distance(nSetIt, --nSetEnd));
   vector<unsigned int>::const_iterator elementIt = nSetIt->begin();
   unsigned int mostSurprisingTupleId = *elementIt;
@@ -109,17 +128,6 @@ bool VisitedPatterns::visited(const vector<vector<unsigned int>>& nSet)
       flatNSet.push_back(*elementIt + *elementOffsetIt);
     }
   while (++elementIt != elementEnd);
-#if REMEMBER == 1
-  pair<mutex, unordered_set<vector<unsigned int>, boost::hash<vector<unsigned int>>>>& firstTuple = firstTuples[mostSurprisingTupleId];
-  firstTuple.first.lock();
-  if (firstTuple.second.emplace(flatNSet).second)
-    {
-      firstTuple.first.unlock();
-      return false;
-    }
-  firstTuple.first.unlock();
-  return true;
-#else  // REMEMBER == 2
   pair<mutex, VisitedPatterns*>& firstTuple = firstTuples[mostSurprisingTupleId];
   firstTuple.first.lock();
   if (firstTuple.second)
@@ -138,12 +146,19 @@ bool VisitedPatterns::visited(const vector<vector<unsigned int>>& nSet)
   firstTuple.second = new VisitedPatternLeaf(flatNSet.begin(), flatNSet.end());
   firstTuple.first.unlock();
   return false;
-#endif
 }
+#endif
 
 void VisitedPatterns::clear()
 {
-#if REMEMBER == 2
+#if REMEMBER == 1
+  if (isFiltered)
+    {
+      VisitedBloomFilter::clear();
+      return;
+    }
+  VisitedFingerprints::clear();
+#else  // REMEMBER == 2
   for (pair<mutex, VisitedPatterns*>& firstTuple : firstTuples)
     {
       if (firstTuple.second)
@@ -152,7 +167,27 @@ void VisitedPatterns::clear()
 	  delete firstTuple.second;
 	}
     }
-#endif
   firstTuples.clear();
   firstTuples.shrink_to_fit();
+#endif
 }
+
+#if REMEMBER == 1
+double VisitedPatterns::getFalsePositiveProbability()
+{
+  if (isFiltered)
+    {
+      return VisitedBloomFilter::getFalsePositiveProbability();
+    }
+  return 0;
+}
+
+unsigned long long VisitedPatterns::getNbOfUnstoredPatterns()
+{
+  if (isFiltered)
+    {
+      return 0;
+    }
+  return VisitedFingerprints::getNbOfRefusedInsertions();
+}
+#endif
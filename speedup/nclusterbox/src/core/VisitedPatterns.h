@@ -17,8 +17,9 @@
 #include <mutex>
 
 #if REMEMBER == 1
-#include <unordered_set>
-#include <boost/container_hash/hash.hpp>
+#include "NSetFingerprint.h"
+#include "VisitedFingerprints.h"
+#include "VisitedBloomFilter.h"
 #endif
 
 using namespace std;
@@ -28,9 +29,17 @@ class VisitedPatterns
 public:
   virtual ~VisitedPatterns();
 
-  static void init(const vector<unsigned int>& cardinalities);
+  static void init(const vector<unsigned int>& cardinalities, const unsigned long long nbOfBytes, const bool isFiltered); // nbOfBytes only bounds the memory and isFiltered only selects a VisitedBloomFilter (rather than VisitedFingerprints) if REMEMBER == 1
+#if REMEMBER == 1
+  static bool visited(const NSetFingerprint& fingerprint); // the fingerprint is maintained by the caller, in O(1) per step
+#else  // REMEMBER == 2
   static bool visited(const vector<vector<unsigned int>>& nSet);
+#endif
   static void clear();
+#if REMEMBER == 1
+  static double getFalsePositiveProbability(); // 0 unless filtered
+  static unsigned long long getNbOfUnstoredPatterns(); // visited patterns that the table, full, could not store; 0 if filtered
+#endif
 
 #if REMEMBER == 2
   virtual bool isPresent() const;
@@ -43,11 +52,12 @@ protected:
 #endif
 
 private:
+#if REMEMBER == 1
+  static bool isFiltered;
+#endif
+#if REMEMBER == 2
   static vector<unsigned int> elementOffsets;
   static vector<unsigned int> tupleOffsets;
-#if REMEMBER == 1
-  static vector<pair<mutex, unordered_set<vector<unsigned int>, boost::hash<vector<unsigned int>>>>> firstTuples;
-#else  // REMEMBER == 2
   static vector<pair<mutex, VisitedPatterns*>> firstTuples;
 #endif
 };
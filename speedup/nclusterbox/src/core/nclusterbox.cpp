@@ -23,6 +23,7 @@
 #include "ConcurrentPatternPool.h"
 #include "ModifiedPattern.h"
 #include "RankPatterns.h"
+#include "VisitedPatterns.h"
 
 using namespace boost::program_options;
 
@@ -34,17 +35,21 @@ int main(int argc, char* argv[])
   float verboseStep = 0;
   long long maxNbOfInitialPatterns = 0;
   int maxSelectionSize = 0;
+  unsigned int nbOfSelectionJobs;
   SelectionCriterion selectionCriterion;
   bool isRSSPrinted;
+  bool isSelectionLazy;
   {
 #ifdef DETAILED_TIME
     steady_clock::time_point startingPoint;
 #endif
     vector<thread> threads;
     bool isModifyingOrGrowing;
+#if REMEMBER == 1
+    bool isVisitedPatternsFiltered = false;
+#endif
+    bool isHopelessClimbsPruned = false;
     {
-      string patternDimensionSeparator;
-      string patternElementSeparator;
       {
 	int nbOfJobs;
 	bool isGrow;
@@ -58,7 +63,8 @@ int main(int argc, char* argv[])
 	      ("help,h", "produce this help message")
 	      ("hio", "produce help on Input/Output format")
 	      ("version,V", "display version information and exit")
-	      ("opt", value<string>(), "set the option file name (by default, [tensor-file].opt if present)");
+	      ("opt", value<string>(), "set the option file name (by default, [tensor-file].opt if present)")
+	      ("convert", value<string>(), "write the tensor in binary file arg, faster to load, and exit");
 	    options_description basicConfig("Basic configuration (on the command line or in the option file)");
 	    basicConfig.add_options()
 	      ("verbose,v", value<float>(), "verbose output every arg seconds")
@@ -66,14 +72,22 @@ int main(int argc, char* argv[])
 	      ("out,o", value<string>(&outputFileName)->default_value("-"), "set output file name")
 	      ("max,m", value<long long>(), "set max nb of initial patterns (by default, unbounded)")
 	      ("forget,f", "do not store the visited patterns")
+#if REMEMBER == 1
+	      ("vmem", value<unsigned int>()->default_value(1024), "set max memory (in MB) storing the visited patterns, which are forgotten beyond")
+	      ("visited-budget", value<unsigned int>(), "filter the visited patterns in arg MB, some never visited patterns being possibly considered visited")
+#endif
 #ifdef DEBUG_MODIFY
-	      ("jobs,j", value<int>(&nbOfJobs)->default_value(1), "set nb of simultaneously modified patterns")
+	      ("jobs,j", value<int>(&nbOfJobs)->default_value(1), "set nb of simultaneously modified patterns, and of threads updating the candidates for selection")
 #else
-	      ("jobs,j", value<int>(&nbOfJobs)->default_value(max(thread::hardware_concurrency(), static_cast<unsigned int>(1))), "set nb of simultaneously modified patterns")
+	      ("jobs,j", value<int>(&nbOfJobs)->default_value(max(thread::hardware_concurrency(), static_cast<unsigned int>(1))), "set nb of simultaneously modified patterns, and of threads updating the candidates for selection")
 #endif
 	      ("density,d", value<float>(), "set threshold between 0 (dense storage of the input tensor) and 1 (default, minimization of memory usage)")
+	      ("stream", "read the tensor, which must be binary (see option convert), from its file at every pass rather than from a copy of its tuples, to use less memory")
+	      ("abandon-climbs", value<unsigned int>(), "abandon the climbs that look unlikely to reach the explanatory power of the arg-th best pattern found so far, according to a heuristic estimate (faster, but locally maximal patterns are missed, including some that would have reached it)")
+	      ("flat", "store the tensor in one contiguous block, to reduce the cache and TLB misses when modifying the patterns")
 	      ("msc", value<string>()->default_value("bic"), "set max selection criterion (rss, aic or bic)")
 	      ("mss", value<int>(), "set max selection size (by default, unbounded)")
+	      ("lazy-select", "only re-evaluate the most promising candidates for selection (faster, but the selection may differ where adding a pattern to the model increases the explanatory power of a candidate)")
 	      ("ns", "neither select nor rank output patterns")
 	      ("shift,s", value<float>(), "shift memberhip degrees by constant in argument (by default, density of input tensor)")
 	      ("expectation,e", "shift every memberhip degree by the max density of the slices covering it")
@@ -152,6 +166,15 @@ int main(int argc, char* argv[])
 		    notify(vm);
 		  }
 	      }
+	    if (vm.count("convert"))
+	      {
+		AbstractRoughTensor::convert(tensorFileName.c_str(), vm["convert"].as<string>().c_str(), vm["tds"].as<string>().c_str(), vm["tes"].as<string>().c_str(), vm.count("boolean"));
+		return EX_OK;
+	      }
+	    if (vm.count("stream") && !BinaryTensorFile::isBinary(tensorFileName.c_str()))
+	      {
+		throw UsageException(("stream option requires a binary tensor (see option convert), but " + tensorFileName + " is not!").c_str());
+	      }
 	    if (vm.count("max"))
 	      {
 		if (vm["max"].as<long long>() < 1)
@@ -160,6 +183,11 @@ int main(int argc, char* argv[])
 		  }
 		maxNbOfInitialPatterns = vm["max"].as<long long>();
 	      }
+	    if (vm["jobs"].as<int>() < 1)
+	      {
+		throw UsageException("jobs option should provide a positive integer!");
+	      }
+	    nbOfSelectionJobs = vm["jobs"].as<int>();
 	    if (vm.count("mss"))
 	      {
 		if (vm["mss"].as<int>() < 1)
@@ -216,6 +244,10 @@ int main(int argc, char* argv[])
 	      {
 		density = 1;
 	      }
+	    if (tensorFileName == "-" && ((vm.count("os") && vm["os"].as<string>() == "-") || (vm.count("patterns") && vm["patterns"].as<string>() == "-")))
+	      {
+		throw UsageException("the tensor and the patterns cannot be both read from the standard input!");
+	      }
 	    if (vm.count("os"))
 	      {
 		const vector<string> ignoredOptions {"forget", "ns", "patterns", "grow"};
@@ -227,24 +259,20 @@ int main(int argc, char* argv[])
 		      }
 		  }
 		isModifyingOrGrowing = false;
-		PatternFileReader::openFile(vm["os"].as<string>().c_str());
+		PatternFileReader::openFile(vm["os"].as<string>().c_str(), vm["pds"].as<string>().c_str(), vm["pes"].as<string>().c_str(), maxNbOfInitialPatterns);
 	      }
 	    else
 	      {
-		if (vm["jobs"].as<int>() < 1)
-		  {
-		    throw UsageException("jobs option should provide a positive integer!");
-		  }
 		isModifyingOrGrowing = true;
 		if (vm.count("patterns"))
 		  {
-		    PatternFileReader::openFile(vm["patterns"].as<string>().c_str());
+		    PatternFileReader::openFile(vm["patterns"].as<string>().c_str(), vm["pds"].as<string>().c_str(), vm["pes"].as<string>().c_str(), maxNbOfInitialPatterns);
 		  }
 		else
 		  {
 		    if (vm.count("os"))
 		      {
-			PatternFileReader::openFile(vm["os"].as<string>().c_str());
+			PatternFileReader::openFile(vm["os"].as<string>().c_str(), vm["pds"].as<string>().c_str(), vm["pes"].as<string>().c_str(), maxNbOfInitialPatterns);
 		      }
 		    else
 		      {
@@ -263,6 +291,10 @@ int main(int argc, char* argv[])
 		  {
 		    cerr << "Warning: density option has no effect here; the expectation option always triggers a completely dense storage of the tensor\n";
 		  }
+		if (vm.count("stream"))
+		  {
+		    cerr << "Warning: stream option has no effect here; the expectation option always triggers a completely dense storage of the tensor\n";
+		  }
 		roughTensor = new DenseRoughTensor(tensorFileName.c_str(), vm["tds"].as<string>().c_str(), vm["tes"].as<string>().c_str(), vm.count("boolean"), verboseStep);
 	      }
 	    else
@@ -273,14 +305,63 @@ int main(int argc, char* argv[])
 		      {
 			throw UsageException("shift option should provide a float in [0, 1[!");
 		      }
-		    roughTensor = AbstractRoughTensor::makeRoughTensor(tensorFileName.c_str(), vm["tds"].as<string>().c_str(), vm["tes"].as<string>().c_str(), density, vm["shift"].as<float>(), vm.count("boolean"), verboseStep);
+		    roughTensor = AbstractRoughTensor::makeRoughTensor(tensorFileName.c_str(), vm["tds"].as<string>().c_str(), vm["tes"].as<string>().c_str(), density, vm["shift"].as<float>(), vm.count("boolean"), vm.count("stream"), verboseStep);
+		  }
+		else
+		  {
+		    roughTensor = AbstractRoughTensor::makeRoughTensor(tensorFileName.c_str(), vm["tds"].as<string>().c_str(), vm["tes"].as<string>().c_str(), density, vm.count("boolean"), vm.count("stream"), verboseStep);
+		  }
+	      }
+#if REMEMBER == 1
+	    if (vm.count("visited-budget"))
+	      {
+		if (!vm["visited-budget"].as<unsigned int>())
+		  {
+		    throw UsageException("visited-budget option should provide a positive integer!");
+		  }
+		if (vm.count("forget"))
+		  {
+		    cerr << "Warning: visited-budget option has no effect here, because forget option used\n";
 		  }
 		else
 		  {
-		    roughTensor = AbstractRoughTensor::makeRoughTensor(tensorFileName.c_str(), vm["tds"].as<string>().c_str(), vm["tes"].as<string>().c_str(), density, vm.count("boolean"), verboseStep);
+		    if (vm["vmem"].defaulted())
+		      {
+			isVisitedPatternsFiltered = true;
+		      }
+		    else
+		      {
+			throw UsageException("vmem and visited-budget options are mutually exclusive!");
+		      }
+		  }
+	      }
+	    if (isVisitedPatternsFiltered)
+	      {
+		ModifiedPattern::setContext(roughTensor, true, vm["visited-budget"].as<unsigned int>() * 1048576ULL, true, vm.count("flat"));
+	      }
+	    else
+	      {
+		ModifiedPattern::setContext(roughTensor, !vm.count("forget"), vm["vmem"].as<unsigned int>() * 1048576ULL, false, vm.count("flat"));
+	      }
+#else
+	    ModifiedPattern::setContext(roughTensor, !vm.count("forget"), 0, false, vm.count("flat"));
+#endif
+	    if (vm.count("abandon-climbs"))
+	      {
+		if (!vm["abandon-climbs"].as<unsigned int>())
+		  {
+		    throw UsageException("abandon-climbs option should provide a positive integer!");
+		  }
+		if (vm.count("grow"))
+		  {
+		    cerr << "Warning: abandon-climbs option has no effect here, because grow option used\n";
+		  }
+		else
+		  {
+		    ModifiedPattern::setHopelessClimbsPruning(vm["abandon-climbs"].as<unsigned int>());
+		    isHopelessClimbsPruned = true;
 		  }
 	      }
-	    ModifiedPattern::setContext(roughTensor, !vm.count("forget"));
 	    if (verboseStep)
 	      {
 		cout << "\rShifting tensor: done.\n";
@@ -302,11 +383,10 @@ int main(int argc, char* argv[])
 		  }
 	      }
 	    isRSSPrinted = vm.count("pr");
+	    isSelectionLazy = vm.count("lazy-select");
 #ifdef DETAILED_TIME
 	    startingPoint = steady_clock::now();
 #endif
-	    patternElementSeparator = vm["pes"].as<string>();
-	    patternDimensionSeparator = vm["pds"].as<string>();
 	  }
 	catch (unknown_option& e)
 	  {
@@ -335,6 +415,7 @@ int main(int argc, char* argv[])
 	  }
 	if (isModifyingOrGrowing)
 	  {
+	    ConcurrentPatternPool::setNbOfWorkers(nbOfJobs);
 	    threads.reserve(nbOfJobs);
 	    if (isGrow)
 	      {
@@ -356,7 +437,7 @@ int main(int argc, char* argv[])
       }
       if (ConcurrentPatternPool::readFromFile())
 	{
-	  PatternFileReader::read(patternDimensionSeparator.c_str(), patternElementSeparator.c_str(), AbstractRoughTensor::getIds2Labels(), maxNbOfInitialPatterns);
+	  PatternFileReader::read(AbstractRoughTensor::getIds2Labels(), maxNbOfInitialPatterns);
 	}
     }
     if (isModifyingOrGrowing)
@@ -402,6 +483,37 @@ int main(int argc, char* argv[])
 #else
 	cout << "Explanatory power maximization time: " << duration_cast<duration<double>>(steady_clock::now() - startingPoint).count() << "s\n";
 #endif
+#endif
+#if REMEMBER == 1
+	if (isVisitedPatternsFiltered)
+	  {
+#ifdef GNUPLOT
+	    cout << '\t' << ModifiedPattern::getNbOfPrunedClimbs() << '\t' << VisitedPatterns::getFalsePositiveProbability();
+#else
+	    cout << "Visited patterns filter: " << ModifiedPattern::getNbOfPrunedClimbs() << " climbs pruned, with an estimated false-positive probability of " << VisitedPatterns::getFalsePositiveProbability() << '\n';
+#endif
+	  }
+#ifndef GNUPLOT
+	else
+	  {
+	    const unsigned long long nbOfUnstoredPatterns = VisitedPatterns::getNbOfUnstoredPatterns();
+	    if (nbOfUnstoredPatterns)
+	      {
+		cout << "Visited patterns table: full, " << nbOfUnstoredPatterns << " visited patterns not stored (see option vmem)\n";
+	      }
+	  }
+#endif
+#endif
+	if (isHopelessClimbsPruned)
+	  {
+#ifdef GNUPLOT
+	    cout << '\t' << ModifiedPattern::getNbOfHopelessClimbs() << '\t' << ModifiedPattern::getAverageNbOfStepsInHopelessClimbs() << '\t' << ModifiedPattern::getAverageNbOfStepsInCompleteClimbs();
+#else
+	    cout << "Hopeless climbs: " << ModifiedPattern::getNbOfHopelessClimbs() << " abandoned after " << ModifiedPattern::getAverageNbOfStepsInHopelessClimbs() << " steps on average, whereas complete climbs take " << ModifiedPattern::getAverageNbOfStepsInCompleteClimbs() << " steps\n";
+#endif
+	  }
+#ifdef NB_OF_ALLOCATIONS
+	cout << "Nb of allocations per initial pattern: " << ModifiedPattern::getNbOfAllocationsPerInitialPattern() << '\n';
 #endif
       }
     else
@@ -454,7 +566,7 @@ int main(int argc, char* argv[])
     }
   else
     {
-      RankPatterns::rank(roughTensor, verboseStep, maxSelectionSize, selectionCriterion, isRSSPrinted);
+      RankPatterns::rank(roughTensor, verboseStep, maxSelectionSize, selectionCriterion, isRSSPrinted, nbOfSelectionJobs, isSelectionLazy);
     }
   delete roughTensor;
 #ifdef TIME